@@ -0,0 +1,278 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <limits>
+#include <numeric>
+#include <functional>
+#include <algorithm>
+#include "approx.h"
+#include "certificate.h"
+#include "thread_pool.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Value;
+
+const static Value NO_MOVE = std::numeric_limits<Value>::max() / 4;
+
+// cheapest change of costs when one participant leaves a group for another and how many of the
+// participants in the group have it
+struct Move {
+  Value cost = NO_MOVE;
+  uint count = 0;
+};
+
+class Approximation {
+public:
+  Approximation(const DensePreferences& preferences, uint group_size, ThreadPool& pool)
+    : m_Preferences(preferences), m_GroupSize(group_size), m_GroupCount(preferences.group_count),
+      m_Pool(pool), m_Groups(preferences.size(), -1), m_Counts(m_GroupCount, 0)
+  {}
+
+  // participants with the most to lose pick their cheapest free group first
+  void seed(){
+    uint participants = m_Preferences.size();
+    std::vector<Value> regrets(participants);
+    m_Pool.parallel_for(participants, [&](uint begin, uint end){
+      for(uint participant = begin; participant < end; ++participant){
+        const Participant::Cost* row = m_Preferences.row(participant);
+        Value best = NO_MOVE, second = NO_MOVE;
+        for(uint group = 0; group < m_GroupCount; ++group){
+          second = row[group] < best ? best : std::min<Value>(second, row[group]);
+          best = std::min<Value>(best, row[group]);
+        }
+        regrets[participant] = second == NO_MOVE ? 0 : second - best;
+      }
+    });
+    std::vector<uint> order(participants);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&regrets](uint a, uint b){ return regrets[a] > regrets[b]; });
+    for(uint participant : order){
+      const Participant::Cost* row = m_Preferences.row(participant);
+      GroupId best = -1;
+      for(uint group = 0; group < m_GroupCount; ++group){
+        if(m_Counts[group] < m_GroupSize && (best < 0 || row[group] < row[best]
+                                             || (row[group] == row[best] && m_Counts[group] < m_Counts[best]))){
+          best = group;
+        }
+      }
+      m_Groups[participant] = best;
+      ++m_Counts[best];
+    }
+  }
+
+  // false when no chain or cycle of moves lowers the costs
+  bool improve(){
+    computeMoves();
+    computeMembers();
+    std::vector<bool> changed(m_GroupCount, false);
+    uint cancelled = 0;
+    while(cancel(changed)){
+      ++cancelled;
+    }
+    add_counter("approx.cancelled", cancelled);
+    return cancelled > 0;
+  }
+
+  std::vector<GroupId>& groups() { return m_Groups; }
+
+private:
+  Move& move(uint from, uint to) { return m_Moves[(std::size_t) from * m_GroupCount + to]; }
+
+  // moves of every group to every other group on blocks of participants, merged afterwards
+  void computeMoves(){
+    uint participants = m_Preferences.size();
+    uint blocks = std::max(1u, std::min(m_Pool.size(), participants));
+    std::size_t table = (std::size_t) m_GroupCount * m_GroupCount;
+    m_BlockMoves.assign(blocks * table, Move());
+    m_Pool.parallel_for(blocks, [&](uint begin, uint end){
+      for(uint block = begin; block < end; ++block){
+        Move* moves = m_BlockMoves.data() + block * table;
+        uint first = (std::size_t) participants * block / blocks;
+        uint last = (std::size_t) participants * (block + 1) / blocks;
+        for(uint participant = first; participant < last; ++participant){
+          const Participant::Cost* row = m_Preferences.row(participant);
+          GroupId from = m_Groups[participant];
+          Move* from_moves = moves + (std::size_t) from * m_GroupCount;
+          for(uint to = 0; to < m_GroupCount; ++to){
+            Value cost = row[to] - row[from];
+            if(cost < from_moves[to].cost){
+              from_moves[to].cost = cost;
+              from_moves[to].count = 1;
+            } else if(cost == from_moves[to].cost){
+              ++from_moves[to].count;
+            }
+          }
+        }
+      }
+    }, 1);
+    m_Moves.assign(m_BlockMoves.begin(), m_BlockMoves.begin() + table);
+    for(uint block = 1; block < blocks; ++block){
+      const Move* moves = m_BlockMoves.data() + block * table;
+      for(std::size_t index = 0; index < table; ++index){
+        if(moves[index].cost < m_Moves[index].cost){
+          m_Moves[index] = moves[index];
+        } else if(moves[index].cost == m_Moves[index].cost){
+          m_Moves[index].count += moves[index].count;
+        }
+      }
+    }
+  }
+
+  // participants of every group in input order
+  void computeMembers(){
+    m_Offsets.assign(m_GroupCount + 1, 0);
+    for(GroupId group : m_Groups){
+      ++m_Offsets[group + 1];
+    }
+    std::partial_sum(m_Offsets.begin(), m_Offsets.end(), m_Offsets.begin());
+    m_Members.resize(m_Groups.size());
+    std::vector<uint> position(m_Offsets.begin(), m_Offsets.end() - 1);
+    for(uint participant = 0; participant < m_Groups.size(); ++participant){
+      m_Members[position[m_Groups[participant]]++] = participant;
+    }
+  }
+
+  // finds a negative cycle or a negative chain into a group with free places by shortest paths over
+  // the moves (see certificate.h) and moves as many participants along it as the moves allow.
+  // groups which lost participants in this round are skipped, their moves are outdated
+  bool cancel(std::vector<bool>& changed){
+    std::vector<Value> prices(m_GroupCount);
+    std::vector<int> next(m_GroupCount, -1);
+    bool free = false;
+    for(uint group = 0; group < m_GroupCount; ++group){
+      free = free || m_Counts[group] < m_GroupSize;
+    }
+    for(uint group = 0; group < m_GroupCount; ++group){
+      prices[group] = !free || m_Counts[group] < m_GroupSize ? 0 : NO_MOVE;
+    }
+    int relaxed = -1;
+    for(uint round = 0; round <= m_GroupCount; ++round){
+      relaxed = -1;
+      for(uint from = 0; from < m_GroupCount; ++from){
+        if(changed[from]) continue;
+        for(uint to = 0; to < m_GroupCount; ++to){
+          Value cost = move(from, to).cost;
+          if(cost != NO_MOVE && prices[to] != NO_MOVE && prices[to] + cost < prices[from]){
+            prices[from] = prices[to] + cost;
+            next[from] = to;
+            relaxed = from;
+          }
+        }
+      }
+      if(relaxed < 0) break;
+    }
+
+    std::vector<uint> chain;
+    uint amount = std::numeric_limits<uint>::max();
+    if(relaxed >= 0){ // still relaxing after all rounds: walk back into the cycle
+      for(uint step = 0; step < m_GroupCount && relaxed >= 0; ++step){
+        relaxed = next[relaxed];
+      }
+      if(relaxed < 0) return false;
+      int group = relaxed;
+      do {
+        chain.push_back(group);
+        group = next[group];
+      } while(group != relaxed);
+      chain.push_back(relaxed);
+    } else if(free){
+      auto lowest = std::min_element(prices.begin(), prices.end());
+      if(*lowest >= 0) return false;
+      for(int group = lowest - prices.begin(); group >= 0; group = next[group]){
+        chain.push_back(group);
+      }
+      amount = m_GroupSize - m_Counts[chain.back()];
+    } else {
+      return false;
+    }
+
+    Value gain = 0;
+    for(uint i = 0; i + 1 < chain.size(); ++i){
+      gain += move(chain[i], chain[i + 1]).cost;
+      amount = std::min(amount, move(chain[i], chain[i + 1]).count);
+    }
+    if(gain >= 0) return false;
+    for(uint i = 0; i + 1 < chain.size(); ++i){
+      uint from = chain[i], to = chain[i + 1];
+      Value cost = move(from, to).cost;
+      uint moved = 0;
+      for(uint index = m_Offsets[from]; index < m_Offsets[from + 1] && moved < amount; ++index){
+        uint participant = m_Members[index];
+        const Participant::Cost* row = m_Preferences.row(participant);
+        if(m_Groups[participant] == (GroupId) from && row[to] - row[from] == cost){
+          m_Groups[participant] = to;
+          ++moved;
+        }
+      }
+      m_Counts[from] -= amount;
+      m_Counts[to] += amount;
+      changed[from] = true;
+    }
+    add_counter("approx.moved", (long long) amount * (chain.size() - 1));
+    return true;
+  }
+
+  const DensePreferences& m_Preferences;
+  const uint m_GroupSize;
+  const uint m_GroupCount;
+  ThreadPool& m_Pool;
+  std::vector<GroupId> m_Groups;
+  std::vector<uint> m_Counts;
+  std::vector<Move> m_Moves;
+  std::vector<Move> m_BlockMoves;
+  std::vector<uint> m_Offsets;
+  std::vector<uint> m_Members;
+};
+
+} // namespace
+
+ApproxResult assign::approx_assignment(const DensePreferences& preferences, uint group_size, uint threads,
+                                       uint rounds)
+{
+  ApproxResult result;
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    result.groups.assign(preferences.size(), -1);
+    return result;
+  }
+  ThreadPool pool(threads);
+  Approximation approximation(preferences, group_size, pool);
+  approximation.seed();
+  while(result.rounds < rounds){
+    ++result.rounds;
+    if(!approximation.improve()) break;
+  }
+  add_counter("approx.rounds", result.rounds);
+  result.groups.swap(approximation.groups());
+  Certificate certificate = certify_assignment(preferences, result.groups, group_size);
+  result.cost = certificate.cost;
+  result.lower_bound = certificate.lower_bound;
+  return result;
+}
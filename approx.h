@@ -0,0 +1,51 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+struct ApproxResult {
+  std::vector<GroupId> groups;
+  long long cost = 0;
+  long long lower_bound = 0; // of certify_assignment, equal to cost when the result is optimal
+  uint rounds = 0;
+};
+
+/**
+ * Near-optimal assignment in about linear time in participants x groups. Participants pick their
+ * cheapest free group in the order of their regret (second cheapest minus cheapest costs), then every
+ * round cancels chains and cycles of moves between the groups which lower the costs. Stops after
+ * rounds or when no round improves anymore. Regrets and moves are computed on threads.
+ */
+ApproxResult approx_assignment(const DensePreferences& preferences, uint group_size, uint threads,
+                               uint rounds = 10);
+
+} // namespace assign
@@ -28,16 +28,37 @@
 #include <map>
 #include <vector>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <iostream>
+#include <memory>
 #include "common.h"
+#include "incremental.h"
+#include "batch.h"
+#include "output.h"
+#include "stats.h"
+#include "cache.h"
+#include "kbest.h"
+#include "whatif.h"
 #include "munkres.h"
 #include "matrix.h"
 
 using namespace assign;
 
+std::string read_next(int& i, int arg_num, char** args, const std::string& argname){
+  if(i+1 >= arg_num){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  ++i;
+  std::string value = args[i];
+  if(!value.empty() && value.at(0) == '-'){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  return value;
+}
+
 void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
   // set default values
   for(int i = 1; i < arg_num; ++i){
@@ -50,6 +71,60 @@ void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
                 << "\t -e | --example \t\t print an example preferences document in the correct format and leave.\n"
                 << "\t -c       | --costs           \t print the calculated costs in addition to the assignment. costs are .\n"
                 << "\t                              \t appended after all assignments.\n"
+                << "\t -p       | --sparse          \t read sparse preferences 'id,group:cost,group:cost,...'. groups\n"
+                << "\t                              \t which are not listed are not assigned to the participant.\n"
+                << "\t                              \t sparse preferences are always solved with the flow solver.\n"
+                << "\t -g <arg> | --groups <arg>    \t number of groups in sparse preferences. defaults to the\n"
+                << "\t                              \t highest listed group + 1.\n"
+                << "\t -i <arg> | --input <arg>     \t read the preferences from a file instead of stdin. csv\n"
+                << "\t                              \t or binary preferences from assign_convert.\n"
+                << "\t -s <arg> | --solver <arg>    \t solver backend. one of: munkres (default), flow,\n"
+                << "\t                              \t lapjv, auction, approx. approx is a fast near-optimal\n"
+                << "\t                              \t assignment which reports its gap to a lower bound.\n"
+                << "\t -t <arg> | --threads <arg>   \t number of threads for parallel solvers. 0 (default) uses\n"
+                << "\t                              \t all cores.\n"
+                << "\t -l <arg> | --time-limit <arg>\t stop after <arg> milliseconds with the best assignment\n"
+                << "\t                              \t found so far. uses the auction solver and reports the\n"
+                << "\t                              \t costs, a lower bound and the gap when it is stopped.\n"
+                << "\t -P       | --progress        \t with --time-limit print every improved assignment as soon\n"
+                << "\t                              \t as it is found behind a line '# cost <c> bound <b>'.\n"
+                << "\t -k <arg> | --k-best <arg>    \t print the <arg> cheapest different assignments, cheapest\n"
+                << "\t                              \t first, each behind a line '# alternative <rank> cost <c>'.\n"
+                << "\t                              \t the first one comes from --solver, which has to be exact.\n"
+                << "\t -w <arg> | --what-if <arg>   \t answer what changes of the optimal assignment cost. reads\n"
+                << "\t                              \t one query per line from the file <arg> or from stdin for\n"
+                << "\t                              \t 'stdin' together with --input:\n"
+                << "\t                              \t   move <id> <group>    <id> has to be in <group>\n"
+                << "\t                              \t   forbid <id> <group>  <id> may not be in <group>\n"
+                << "\t                              \t   swap <id> <id>       the two exchange their groups\n"
+                << "\t                              \t each answer is a line '# <query> delta <d>' followed by\n"
+                << "\t                              \t the participants that get a new group.\n"
+                << "\t -C <arg> | --cache <arg>     \t keep results in the directory <arg>. equal preferences\n"
+                << "\t                              \t and options return the stored result, a single layer\n"
+                << "\t                              \t where few participants changed is repaired from it.\n"
+                << "\t -B       | --binary          \t write the assignment in the binary format of output.h\n"
+                << "\t                              \t instead of csv. --costs adds the costs. warnings go\n"
+                << "\t                              \t to stderr.\n"
+                << "\t -v       | --verify          \t prove that the assignment is optimal with prices on the\n"
+                << "\t                              \t groups or report a lower bound and the gap to it.\n"
+                << "\t -q <arg> | --stats <arg>     \t write run statistics as json to the file <arg> or to\n"
+                << "\t                              \t stderr for 'stderr': time per phase, counters of the solvers,\n"
+                << "\t                              \t matrix dimensions, costs of the heuristic and memory.\n"
+                << "\t -Q <arg> | --trace <arg>     \t write the phases in the chrome trace format to <arg>.\n"
+                << "\t -b       | --batch           \t solve many instances. each starts with a line '# <name>'\n"
+                << "\t                              \t or is a file in the --input directory. instances are\n"
+                << "\t                              \t solved in parallel on --threads and printed in input\n"
+                << "\t                              \t order behind their header line.\n"
+                << "\t -S       | --serve           \t keep running and read changes from stdin, one per line:\n"
+                << "\t                              \t   add <id>,<cost>,...    adds a participant\n"
+                << "\t                              \t   update <id>,<cost>,... changes its preferences\n"
+                << "\t                              \t   remove <id>            removes a participant\n"
+                << "\t                              \t   get <id> | print | cost | quit\n"
+                << "\t                              \t changes answer with the participants that got a new\n"
+                << "\t                              \t group, every answer ends with 'ok' or 'error <text>'.\n"
+                << "\t                              \t --input and --groups may set the initial participants\n"
+                << "\t                              \t and the number of groups. every change is solved from\n"
+                << "\t                              \t the previous assignment, --solver is not used.\n"
                 << std::endl;
       std::exit(0);
     } else if (arg == "--example" || arg == "-e"){
@@ -61,24 +136,372 @@ void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
       std::exit(0);
     } else if (arg == "--costs" || arg == "-c"){
       prog_args_dst["costs"] = "1";
+    } else if (arg == "--binary" || arg == "-B"){
+      prog_args_dst["binary"] = "1";
+    } else if (arg == "--batch" || arg == "-b"){
+      prog_args_dst["batch"] = "1";
+    } else if (arg == "--serve" || arg == "-S"){
+      prog_args_dst["serve"] = "1";
+    } else if (arg == "--sparse" || arg == "-p"){
+      prog_args_dst["sparse"] = "1";
+    } else if (arg == "--groups" || arg == "-g"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["groups"] = next;
+    } else if (arg == "--input" || arg == "-i"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["input"] = next;
+    } else if (arg == "--solver" || arg == "-s"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["solver"] = next;
+    } else if (arg == "--time-limit" || arg == "-l"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["time-limit"] = next;
+    } else if (arg == "--k-best" || arg == "-k"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["k-best"] = next;
+    } else if (arg == "--what-if" || arg == "-w"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["what-if"] = next;
+    } else if (arg == "--progress" || arg == "-P"){
+      prog_args_dst["progress"] = "1";
+    } else if (arg == "--verify" || arg == "-v"){
+      prog_args_dst["verify"] = "1";
+    } else if (arg == "--stats" || arg == "-q"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["stats"] = next;
+    } else if (arg == "--trace" || arg == "-Q"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["trace"] = next;
+    } else if (arg == "--cache" || arg == "-C"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["cache"] = next;
+    } else if (arg == "--threads" || arg == "-t"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["threads"] = next;
     } else {
       ERROR(1,"Unknown command line parameter' " << arg);
     }
   }
 }
 
-int main(int arg_num, char** args) {
+bool parse_change(const std::string& data, Participant& dst){
+  dst = Participant::fromCsvLine(data);
+  return !dst.id.empty() && !dst.preferences.empty();
+}
+
+void serve(ProgArgs& prog_args){
+  bool print_costs = !prog_args["costs"].empty();
+  std::unique_ptr<IncrementalAssignment> assignment;
+  if(!prog_args["input"].empty()){
+    auto preferences = DensePreferences::fromFile(prog_args["input"]);
+    assignment.reset(new IncrementalAssignment(preferences.group_count));
+    if(!assignment->add(preferences)){
+      ERROR(1, "Initial participants have duplicate ids.");
+    }
+  } else if(!prog_args["groups"].empty()){
+    assignment.reset(new IncrementalAssignment(parse<uint>(prog_args["groups"])));
+  }
+  std::string line;
+  while(std::getline(std::cin, line)){
+    std::size_t space = line.find(' ');
+    std::string command = line.substr(0, space);
+    std::string data = space == std::string::npos ? std::string() : line.substr(space + 1);
+    Participant participant;
+    if(command == "quit"){
+      break;
+    } else if(command == "add" || command == "update"){
+      if(!parse_change(data, participant)){
+        std::cout << "error expected " << command << " <id>,<cost>,<cost>,..." << std::endl;
+        continue;
+      }
+      if(!assignment){
+        assignment.reset(new IncrementalAssignment(participant.preferences.size()));
+      }
+      bool done = command == "add" ? assignment->add(participant.id, participant.preferences)
+                                   : assignment->update(participant.id, participant.preferences);
+      if(!done){
+        std::cout << "error could not " << command << " '" << participant.id << "'. expected "
+                  << (command == "add" ? "a new id" : "a known id") << " and "
+                  << assignment->groupCount() << " preferences." << std::endl;
+        continue;
+      }
+      print_assignments_csv(assignment->changed(), print_costs);
+    } else if(command == "remove"){
+      if(!assignment || !assignment->remove(data)){
+        std::cout << "error unknown participant '" << data << "'." << std::endl;
+        continue;
+      }
+      print_assignments_csv(assignment->changed(), print_costs);
+    } else if(command == "get"){
+      if(!assignment || assignment->group(data) < 0){
+        std::cout << "error unknown participant '" << data << "'." << std::endl;
+        continue;
+      }
+      std::cout << data << "," << assignment->group(data) << std::endl;
+    } else if(command == "print"){
+      if(assignment){
+        print_assignments_csv(assignment->assignments(), print_costs);
+      }
+    } else if(command == "cost"){
+      std::cout << (assignment ? assignment->cost() : 0) << std::endl;
+    } else if(!command.empty()){
+      std::cout << "error unknown command '" << command << "'." << std::endl;
+      continue;
+    } else {
+      continue;
+    }
+    std::cout << "ok" << std::endl;
+  }
+}
+
+void solve_batch(ProgArgs& prog_args){
+  const std::string input = prog_args["input"];
+  auto instances = input.empty() ? read_batch(std::cin) : read_batch(input);
+  bool sparse = !prog_args["sparse"].empty();
+  bool print_costs = !prog_args["costs"].empty();
+  uint groups = parse<uint>(prog_args["groups"]);
+  SolverOptions options = parse_solver_options(prog_args);
+  uint threads = options.threads;
+  options.threads = 1; // the instances run in parallel instead
+  run_batch(instances, [&](const BatchInstance& instance, std::ostream& output){
+    if(sparse){
+      Assignment problem(instance.sparse(groups),options);
+      write_assignments_csv(problem.solveCompact(),print_costs,output);
+    } else {
+      Assignment problem(instance.dense(),0,std::vector<std::pair<uint,uint>>(),options);
+      write_assignments_csv(problem.solveCompact(),print_costs,output);
+    }
+  }, threads, std::cout);
+}
+
+void print_k_best(const DensePreferences& preferences, uint k, const SolverOptions& options, bool print_costs){
+  std::vector<RankedAssignment> alternatives;
+  {
+    StatsPhase phase("solve");
+    alternatives = k_best_assignments(preferences, k, options);
+  }
+  StatsPhase phase("write");
+  for(uint rank = 0; rank < alternatives.size(); ++rank){
+    std::cout << "# alternative " << rank + 1 << " cost " << alternatives[rank].cost << "\n";
+    for(uint i = 0; i < preferences.size(); ++i){
+      GroupId group = alternatives[rank].groups[i];
+      std::cout << preferences.ids[i] << "," << group;
+      if(print_costs){
+        std::cout << "," << (group < 0 ? -1 : preferences.row(i)[group]);
+      }
+      std::cout << "\n";
+    }
+  }
+  std::cout << std::flush;
+}
+
+void answer_query(const WhatIf& what_if, const std::map<Participant::Id,uint>& index,
+                  const DensePreferences& preferences, const std::string& query){
+  std::istringstream stream(query);
+  std::string command, first, second;
+  stream >> command >> first >> second;
+  auto participant = [&](const std::string& id, uint& dst){
+    auto found = index.find(id);
+    if(found == index.end()){
+      std::cout << "# " << query << " error unknown participant '" << id << "'.\n";
+      return false;
+    }
+    dst = found->second;
+    return true;
+  };
+  auto group = [&](const std::string& data, GroupId& dst){
+    std::istringstream group_stream(data);
+    if(!(group_stream >> dst) || !group_stream.eof() || dst < 0 || (uint) dst >= preferences.group_count){
+      std::cout << "# " << query << " error unknown group '" << data << "'.\n";
+      return false;
+    }
+    return true;
+  };
+  WhatIfAnswer answer;
+  uint subject = 0, other = 0;
+  GroupId target = 0;
+  if(command == "move" || command == "forbid"){
+    if(!participant(first, subject) || !group(second, target)) return;
+    answer = command == "move" ? what_if.move(subject, target) : what_if.forbid(subject, target);
+  } else if(command == "swap"){
+    if(!participant(first, subject) || !participant(second, other)) return;
+    answer = what_if.swap(subject, other);
+  } else {
+    std::cout << "# " << query << " error expected move <id> <group>, forbid <id> <group> or swap <id> <id>.\n";
+    return;
+  }
+  if(!answer.feasible){
+    std::cout << "# " << query << " infeasible\n";
+    return;
+  }
+  std::cout << "# " << query << " delta " << answer.delta << "\n";
+  for(const std::pair<uint,GroupId>& move : answer.moves){
+    std::cout << preferences.ids[move.first] << "," << move.second << "\n";
+  }
+}
+
+void answer_what_if(const DensePreferences& preferences, const std::string& queries, const SolverOptions& options){
+  std::vector<GroupId> groups;
+  {
+    StatsPhase phase("solve");
+    groups = solve_groups(preferences, options);
+  }
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    ERROR(1, "--what-if needs participants and groups.");
+  }
+  StatsPhase phase("what-if");
+  WhatIf what_if(preferences, groups);
+  if(!what_if.exact()){
+    WARNING("The assignment is not optimal, the deltas of --what-if are only upper bounds.");
+  }
+  std::map<Participant::Id,uint> index;
+  for(uint i = 0; i < preferences.size(); ++i){
+    index.insert(std::make_pair(preferences.ids[i], i));
+  }
+  std::ifstream file;
+  if(queries != "stdin"){
+    file.open(queries);
+    if(!file){
+      ERROR(1, "Could not open what-if queries '" << queries << "'.");
+    }
+  }
+  std::istream& input = queries == "stdin" ? std::cin : file;
+  std::string query;
+  uint count = 0;
+  while(std::getline(input, query)){
+    if(query.empty()) continue;
+    answer_query(what_if, index, preferences, query);
+    ++count;
+  }
+  add_counter("whatif.queries", count);
+  std::cout << std::flush;
+}
+
+AssignmentResult solve_timed(const Assignment& problem){
+  StatsPhase phase("solve");
+  return problem.solveCompact();
+}
+
+void write_result(const AssignmentResult& result, ProgArgs& prog_args){
+  StatsPhase phase("write");
+  bool print_costs = !prog_args["costs"].empty();
+  if(!prog_args["binary"].empty()){
+    write_assignments_binary(result,print_costs);
+  } else {
+    write_assignments_csv(result,print_costs);
+  }
+}
+
+int run(int arg_num, char** args) {
 
   ProgArgs prog_args;
   process_args(arg_num,args,prog_args);
+  if(!prog_args["binary"].empty()){ // keep the binary output clean
+    set_default_warning_stream(&std::cerr);
+  }
+  if(!prog_args["stats"].empty() || !prog_args["trace"].empty()){
+    enable_stats();
+  }
 
-  auto participants = Participant::fromCsv(std::cin);
+  for(const char* option : {"k-best", "what-if"}){
+    if(prog_args[option].empty()) continue;
+    for(const char* other : {"serve", "batch", "sparse", "binary", "progress", "k-best", "cache"}){
+      if(std::string(option) != other && !prog_args[other].empty()){
+        ERROR(1, "--" << option << " can not be combined with --" << other << ".");
+      }
+    }
+  }
+  if(!prog_args["cache"].empty()){
+    for(const char* other : {"serve", "batch", "sparse", "progress"}){
+      if(!prog_args[other].empty()){
+        ERROR(1, "--cache can not be combined with --" << other << ".");
+      }
+    }
+  }
+  if(!prog_args["binary"].empty() && !prog_args["progress"].empty()){ // progress lines are csv
+    ERROR(1, "--progress can not be combined with --binary.");
+  }
+  if(prog_args["what-if"] == "stdin" && prog_args["input"].empty()){
+    ERROR(1, "--what-if stdin needs the preferences from --input.");
+  }
 
-  Assignment problem(participants);
-  auto assignments = problem.solve();
+  if(!prog_args["serve"].empty()){
+    serve(prog_args);
+    return 0;
+  }
+  if(!prog_args["batch"].empty()){
+    if(!prog_args["binary"].empty()){
+      ERROR(1, "--binary can not be combined with --batch.");
+    }
+    solve_batch(prog_args);
+    write_stats(prog_args["stats"], prog_args["trace"]);
+    return 0;
+  }
 
-  print_assignments_csv(assignments,!prog_args["costs"].empty());
+  const std::string input = prog_args["input"];
+  if(!prog_args["sparse"].empty()){
+    uint groups = parse<uint>(prog_args["groups"]);
+    SparsePreferences preferences;
+    {
+      StatsPhase phase("read");
+      preferences = input.empty() ? SparsePreferences::fromCsv(std::cin, groups)
+                                  : SparsePreferences::fromCsvFile(input, groups);
+    }
+    Assignment problem(std::move(preferences),parse_solver_options(prog_args));
+    write_result(solve_timed(problem), prog_args);
+  } else {
+    DensePreferences preferences;
+    {
+      StatsPhase phase("read");
+      preferences = input.empty() ? DensePreferences::fromCsv(std::cin) : DensePreferences::fromFile(input);
+    }
+    SolverOptions options = parse_solver_options(prog_args);
+    if(!prog_args["k-best"].empty()){
+      print_k_best(preferences, parse<uint>(prog_args["k-best"]), options, !prog_args["costs"].empty());
+      write_stats(prog_args["stats"], prog_args["trace"]);
+      return 0;
+    }
+    if(!prog_args["what-if"].empty()){
+      answer_what_if(preferences, prog_args["what-if"], options);
+      write_stats(prog_args["stats"], prog_args["trace"]);
+      return 0;
+    }
+    if(!prog_args["cache"].empty()){
+      ResultCache cache(prog_args["cache"], std::vector<uint>(), std::vector<std::pair<uint,uint>>(), options);
+      AssignmentResult result;
+      {
+        StatsPhase phase("solve");
+        result = cache.solve(preferences);
+      }
+      write_result(result, prog_args);
+      write_stats(prog_args["stats"], prog_args["trace"]);
+      return 0;
+    }
+    std::vector<Participant::Id> ids;
+    if(!prog_args["progress"].empty()){
+      ids = preferences.ids;
+      options.progress = [&ids](const std::vector<GroupId>& groups, long long cost, long long lower_bound){
+        std::cout << "# cost " << cost << " bound " << lower_bound << "\n";
+        for(uint i = 0; i < ids.size(); ++i){
+          std::cout << ids[i] << "," << groups[i] << "\n";
+        }
+        std::cout << std::flush;
+      };
+    }
+    Assignment problem(std::move(preferences),0,std::vector<std::pair<uint,uint>>(),options);
+    write_result(solve_timed(problem), prog_args);
+  }
+  write_stats(prog_args["stats"], prog_args["trace"]);
 
   return 0;
 }
 
+int main(int arg_num, char** args) {
+  set_default_warning_stream(&std::cout);
+  try {
+    return run(arg_num, args);
+  } catch(const Error& error) {
+    std::cout << "ERROR: " << error.what() << std::endl;
+    return error.code();
+  }
+}
@@ -0,0 +1,450 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <map>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "common.h"
+
+using namespace assign;
+
+namespace {
+
+// larger instances are skipped for the solvers which build a participants x participants matrix
+const char* DEFAULT_MUNKRES_LIMIT = "2000";
+const char* DEFAULT_LAPJV_LIMIT = "10000";
+// number of distinct preference profiles of the duplicate generator
+const uint DUPLICATE_PROFILES = 16;
+
+typedef std::mt19937 Random;
+
+struct Run {
+  std::string generator;
+  std::string scenario;
+  std::string solver;
+  uint threads = 1;
+  uint participants = 0;
+  uint groups = 0;
+  std::string status = "ok";
+  double seconds = 0;
+  long peak_rss_kb = 0;
+  long long cost = 0;
+};
+
+}
+
+std::string read_next(int& i, int arg_num, char** args, const std::string& argname){
+  if(i+1 >= arg_num){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  ++i;
+  std::string value = args[i];
+  if(!value.empty() && value.at(0) == '-'){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  return value;
+}
+
+void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
+  // set default values
+  prog_args_dst["participants"] = "100,1000,10000,100000,1000000";
+  prog_args_dst["groups"] = "10";
+  prog_args_dst["generators"] = "uniform,ranked,popular,duplicate,sparse";
+  prog_args_dst["scenarios"] = "single";
+  prog_args_dst["solvers"] = "flow,lapjv,auction,munkres";
+  prog_args_dst["threads"] = std::to_string(std::max(1u, std::thread::hardware_concurrency()));
+  prog_args_dst["seed"] = "1";
+  prog_args_dst["top"] = "3";
+  prog_args_dst["munkres-limit"] = DEFAULT_MUNKRES_LIMIT;
+  prog_args_dst["lapjv-limit"] = DEFAULT_LAPJV_LIMIT;
+  prog_args_dst["format"] = "csv";
+  for(int i = 1; i < arg_num; ++i){
+    std::string arg = args[i];
+    if(arg == "--help" || arg == "-h"){
+      std::cout << "This application solves generated instances with every solver and reports wall time, peak\n"
+                << "  resident memory and total cost of each run. Every run is done in its own process.\n"
+                << "  Lists are comma separated.\n\n"
+                << "Usage: assign_bench [parameters]\n\n"
+                << "Parameters:\n"
+                << "\t -h       | --help               \t print this message and leave.\n"
+                << "\t -n <arg> | --participants <arg> \t list of participant counts (default 100,...,1000000).\n"
+                << "\t -g <arg> | --groups <arg>       \t number of groups (default 10).\n"
+                << "\t -G <arg> | --generators <arg>   \t list of instance generators (default all):\n"
+                << "\t                                 \t   uniform   - random costs from 1 to 10\n"
+                << "\t                                 \t   ranked    - every participant ranks the groups 1..g\n"
+                << "\t                                 \t   popular   - ranks where few groups are popular with all\n"
+                << "\t                                 \t   duplicate - ranks drawn from " << DUPLICATE_PROFILES
+                << " profiles\n"
+                << "\t                                 \t   sparse    - popular ranks, only the top ranks listed\n"
+                << "\t -S <arg> | --scenarios <arg>    \t list of scenarios (default single):\n"
+                << "\t                                 \t   single    - one assignment over all groups\n"
+                << "\t                                 \t   split     - two assignments split in the middle\n"
+                << "\t                                 \t   exclusive - split where the i-th groups of both\n"
+                << "\t                                 \t               halves are mutually exclusive\n"
+                << "\t -s <arg> | --solvers <arg>      \t list of solvers (default flow,lapjv,auction,munkres).\n"
+                << "\t -t <arg> | --threads <arg>      \t maximal number of auction threads (default all cores).\n"
+                << "\t                                 \t the auction runs with 1,2,4,... up to <arg> threads.\n"
+                << "\t -k <arg> | --top <arg>          \t listed groups of the sparse generator (default 3).\n"
+                << "\t -r <arg> | --seed <arg>         \t random seed (default 1).\n"
+                << "\t          | --munkres-limit <arg>\t largest instance for munkres (default "
+                << DEFAULT_MUNKRES_LIMIT << ").\n"
+                << "\t          | --lapjv-limit <arg>  \t largest instance for lapjv (default "
+                << DEFAULT_LAPJV_LIMIT << ").\n"
+                << "\t -f <arg> | --format <arg>       \t csv or json (one object per line, default csv).\n"
+                << "\t -i <arg> | --input <arg>        \t measure the throughput of reading a preferences file instead.\n"
+                << std::endl;
+      std::exit(0);
+    } else if (arg == "--participants" || arg == "-n"){
+      prog_args_dst["participants"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--groups" || arg == "-g"){
+      prog_args_dst["groups"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--generators" || arg == "-G"){
+      prog_args_dst["generators"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--scenarios" || arg == "-S"){
+      prog_args_dst["scenarios"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--solvers" || arg == "-s"){
+      prog_args_dst["solvers"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--threads" || arg == "-t"){
+      prog_args_dst["threads"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--top" || arg == "-k"){
+      prog_args_dst["top"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--seed" || arg == "-r"){
+      prog_args_dst["seed"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--munkres-limit"){
+      prog_args_dst["munkres-limit"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--lapjv-limit"){
+      prog_args_dst["lapjv-limit"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--format" || arg == "-f"){
+      prog_args_dst["format"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--input" || arg == "-i"){
+      prog_args_dst["input"] = read_next(i, arg_num, args, arg);
+    } else {
+      ERROR(1,"Unknown command line parameter' " << arg);
+    }
+  }
+}
+
+namespace {
+
+// group order of one participant. zipf distributed popularity when popular is set, uniform otherwise
+std::vector<uint> group_order(uint groups, bool popular, Random& random){
+  std::vector<uint> order(groups);
+  std::iota(order.begin(), order.end(), 0);
+  if(!popular){
+    std::shuffle(order.begin(), order.end(), random);
+    return order;
+  }
+  // weighted sampling without replacement: sort by u^(1/w) with w = 1/(group+1)
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::vector<double> keys(groups);
+  for(uint group = 0; group < groups; ++group){
+    keys[group] = std::log(uniform(random)) * (group + 1);
+  }
+  std::sort(order.begin(), order.end(), [&keys](uint a, uint b){ return keys[a] > keys[b]; });
+  return order;
+}
+
+void rank_costs(const std::vector<uint>& order, Participant::Cost* costs){
+  for(uint rank = 0; rank < order.size(); ++rank){
+    costs[order[rank]] = rank + 1;
+  }
+}
+
+DensePreferences dense_instance(const std::string& generator, uint participants, uint groups, uint seed){
+  Random random(seed);
+  DensePreferences result;
+  result.group_count = groups;
+  result.ids.reserve(participants);
+  result.costs.resize((std::size_t) participants * groups);
+  std::vector<std::vector<uint>> profiles;
+  if(generator == "duplicate"){
+    for(uint profile = 0; profile < DUPLICATE_PROFILES; ++profile){
+      profiles.push_back(group_order(groups, false, random));
+    }
+  }
+  std::uniform_int_distribution<Participant::Cost> cost(1, 10);
+  std::uniform_int_distribution<uint> profile(0, DUPLICATE_PROFILES - 1);
+  for(uint participant = 0; participant < participants; ++participant){
+    result.ids.push_back("p" + std::to_string(participant));
+    Participant::Cost* row = result.row(participant);
+    if(generator == "uniform"){
+      for(uint group = 0; group < groups; ++group){
+        row[group] = cost(random);
+      }
+    } else if(generator == "ranked" || generator == "popular"){
+      rank_costs(group_order(groups, generator == "popular", random), row);
+    } else if(generator == "duplicate"){
+      rank_costs(profiles[profile(random)], row);
+    } else {
+      ERROR(1, "Unknown generator '" << generator << "'.");
+    }
+  }
+  return result;
+}
+
+SparsePreferences sparse_instance(uint participants, uint groups, uint top, uint seed){
+  Random random(seed);
+  SparsePreferences result;
+  result.group_count = groups;
+  top = std::min(top, groups);
+  for(uint participant = 0; participant < participants; ++participant){
+    result.ids.push_back("p" + std::to_string(participant));
+    auto order = group_order(groups, true, random);
+    for(uint rank = 0; rank < top; ++rank){
+      result.groups.push_back(order[rank]);
+      result.costs.push_back(rank + 1);
+    }
+    result.offsets.push_back(result.groups.size());
+  }
+  return result;
+}
+
+long long total_cost(const std::vector<Assignment::ParticipantAssignment>& assignments){
+  long long result = 0;
+  for(const Assignment::ParticipantAssignment& assignment : assignments){
+    for(Participant::Cost cost : assignment.costs){
+      result += cost;
+    }
+  }
+  return result;
+}
+
+// generates and solves the instance. returns wall time of the solver
+double solve(Run& run, const ProgArgs& prog_args){
+  SolverOptions options;
+  options.solver = parse_solver(run.solver);
+  options.threads = run.threads;
+  uint seed = parse<uint>(prog_args.at("seed"));
+  if(run.generator == "sparse"){
+    Assignment problem(sparse_instance(run.participants, run.groups, parse<uint>(prog_args.at("top")), seed), options);
+    auto start = std::chrono::steady_clock::now();
+    auto assignments = problem.solve();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.cost = total_cost(assignments);
+    return seconds;
+  }
+  uint split = run.scenario == "single" ? 0 : run.groups / 2;
+  std::vector<std::pair<uint,uint>> exclusive;
+  if(run.scenario == "exclusive"){
+    for(uint group = 0; group < split && group < run.groups - split; ++group){
+      exclusive.push_back(std::make_pair(group, group));
+    }
+  }
+  Assignment problem(dense_instance(run.generator, run.participants, run.groups, seed), split, exclusive, options);
+  auto start = std::chrono::steady_clock::now();
+  auto assignments = problem.solve();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  run.cost = total_cost(assignments);
+  return seconds;
+}
+
+// runs in a child process so that the peak memory can be measured per run
+void measure(Run& run, const ProgArgs& prog_args){
+  int channel[2];
+  if(pipe(channel) != 0){
+    ERROR(1, "Could not create a pipe.");
+  }
+  std::cout.flush();
+  pid_t child = fork();
+  if(child < 0){
+    ERROR(1, "Could not fork the benchmark process.");
+  }
+  if(child == 0){
+    // solver warnings would end up between the results
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(channel[0]);
+    run.seconds = solve(run, prog_args);
+    std::string result = std::to_string(run.seconds) + " " + std::to_string(run.cost);
+    if(write(channel[1], result.c_str(), result.size()) != (ssize_t) result.size()){
+      _exit(1);
+    }
+    _exit(0);
+  }
+  close(channel[1]);
+  std::string result;
+  char buffer[256];
+  ssize_t read_bytes;
+  while((read_bytes = read(channel[0], buffer, sizeof(buffer))) > 0){
+    result.append(buffer, read_bytes);
+  }
+  close(channel[0]);
+  int status = 0;
+  struct rusage usage;
+  wait4(child, &status, 0, &usage);
+  run.peak_rss_kb = usage.ru_maxrss;
+  if(!WIFEXITED(status) || WEXITSTATUS(status) != 0 || result.empty()){
+    run.status = "failed";
+    return;
+  }
+  std::istringstream stream(result);
+  stream >> run.seconds >> run.cost;
+}
+
+// reason why a run is not done or an empty string
+std::string skip_reason(const Run& run, const ProgArgs& prog_args){
+  if(run.generator == "sparse" && run.solver != "flow"){
+    return "skipped_dense_only";
+  }
+  if(run.generator == "sparse" && run.scenario != "single"){
+    return "skipped_single_only";
+  }
+  if(run.scenario != "single" && run.groups < 2){
+    return "skipped_too_few_groups";
+  }
+  if(run.solver == "munkres" && run.participants > parse<uint>(prog_args.at("munkres-limit"))){
+    return "skipped_too_large";
+  }
+  if(run.solver == "lapjv" && run.participants > parse<uint>(prog_args.at("lapjv-limit"))){
+    return "skipped_too_large";
+  }
+  return "";
+}
+
+void print_header(const std::string& format){
+  if(format == "csv"){
+    std::cout << "generator,scenario,solver,threads,participants,groups,status,seconds,peak_rss_kb,cost" << std::endl;
+  }
+}
+
+void print_run(const Run& run, const std::string& format){
+  if(format == "json"){
+    std::cout << "{\"generator\":\"" << run.generator << "\",\"scenario\":\"" << run.scenario
+              << "\",\"solver\":\"" << run.solver << "\",\"threads\":" << run.threads
+              << ",\"participants\":" << run.participants << ",\"groups\":" << run.groups
+              << ",\"status\":\"" << run.status << "\",\"seconds\":" << run.seconds
+              << ",\"peak_rss_kb\":" << run.peak_rss_kb << ",\"cost\":" << run.cost << "}" << std::endl;
+  } else {
+    std::cout << run.generator << "," << run.scenario << "," << run.solver << "," << run.threads << ","
+              << run.participants << "," << run.groups << "," << run.status << "," << run.seconds << ","
+              << run.peak_rss_kb << "," << run.cost << std::endl;
+  }
+}
+
+void benchmark_input(const std::string& path){
+  std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+  double megabytes = file.tellg() / (1024. * 1024.);
+  auto start = std::chrono::steady_clock::now();
+  auto preferences = DensePreferences::fromFile(path);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "input,megabytes,participants,groups,seconds,megabytes_per_second" << std::endl;
+  std::cout << path << "," << megabytes << "," << preferences.size() << "," << preferences.group_count << ","
+            << seconds << "," << megabytes / seconds << std::endl;
+}
+
+}
+
+int run(int arg_num, char** args) {
+
+  ProgArgs prog_args;
+  process_args(arg_num,args,prog_args);
+
+  if(!prog_args["input"].empty()){
+    benchmark_input(prog_args["input"]);
+    return 0;
+  }
+
+  const std::string format = prog_args["format"];
+  if(format != "csv" && format != "json"){
+    ERROR(1, "Unknown format '" << format << "'.");
+  }
+  auto sizes = parse_vector<uint>(split(prog_args["participants"], ','));
+  auto generators = split(prog_args["generators"], ',');
+  auto scenarios = split(prog_args["scenarios"], ',');
+  auto solvers = split(prog_args["solvers"], ',');
+  for(const std::string& generator : generators){
+    if(generator != "uniform" && generator != "ranked" && generator != "popular" && generator != "duplicate"
+       && generator != "sparse"){
+      ERROR(1, "Unknown generator '" << generator << "'.");
+    }
+  }
+  for(const std::string& scenario : scenarios){
+    if(scenario != "single" && scenario != "split" && scenario != "exclusive"){
+      ERROR(1, "Unknown scenario '" << scenario << "'.");
+    }
+  }
+  for(const std::string& solver : solvers){
+    parse_solver(solver);
+  }
+
+  uint max_threads = parse<uint>(prog_args["threads"]);
+  std::vector<uint> auction_threads;
+  for(uint threads = 1; threads < max_threads; threads *= 2){
+    auction_threads.push_back(threads);
+  }
+  auction_threads.push_back(std::max(1u, max_threads));
+
+  print_header(format);
+  for(const std::string& generator : generators){
+    for(const std::string& scenario : scenarios){
+      for(uint participants : sizes){
+        for(const std::string& solver : solvers){
+          std::vector<uint> thread_counts = solver == "auction" ? auction_threads : std::vector<uint>(1, 1);
+          for(uint threads : thread_counts){
+            Run run;
+            run.generator = generator;
+            run.scenario = scenario;
+            run.solver = solver;
+            run.threads = threads;
+            run.participants = participants;
+            run.groups = parse<uint>(prog_args["groups"]);
+            std::string skipped = skip_reason(run, prog_args);
+            if(skipped.empty()){
+              measure(run, prog_args);
+            } else {
+              run.status = skipped;
+            }
+            print_run(run, format);
+          }
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int main(int arg_num, char** args) {
+  set_default_warning_stream(&std::cout);
+  try {
+    return run(arg_num, args);
+  } catch(const Error& error) {
+    std::cout << "ERROR: " << error.what() << std::endl;
+    return error.code();
+  }
+}
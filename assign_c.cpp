@@ -0,0 +1,92 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <new>
+#include <algorithm>
+#include "assign_c.h"
+#include "workspace.h"
+
+struct assign_workspace {
+  explicit assign_workspace(const assign::SolverOptions& options) : workspace(options) {}
+  assign::SolverWorkspace workspace;
+};
+
+int assign_abi_version(void){
+  return ASSIGN_ABI_VERSION;
+}
+
+assign_workspace* assign_workspace_create(int solver, unsigned int threads){
+  assign::SolverOptions options;
+  switch(solver){
+    case ASSIGN_SOLVER_MUNKRES: options.solver = assign::Solver::MUNKRES; break;
+    case ASSIGN_SOLVER_FLOW: options.solver = assign::Solver::FLOW; break;
+    case ASSIGN_SOLVER_LAPJV: options.solver = assign::Solver::LAPJV; break;
+    case ASSIGN_SOLVER_AUCTION: options.solver = assign::Solver::AUCTION; break;
+    case ASSIGN_SOLVER_APPROX: options.solver = assign::Solver::APPROX; break;
+    default: return nullptr;
+  }
+  options.threads = threads;
+  return new (std::nothrow) assign_workspace(options);
+}
+
+void assign_workspace_destroy(assign_workspace* workspace){
+  delete workspace;
+}
+
+int assign_workspace_reserve(assign_workspace* workspace, unsigned int participants, unsigned int groups){
+  if(workspace == nullptr){
+    return ASSIGN_INVALID_ARGUMENT;
+  }
+  try {
+    workspace->workspace.reserve(participants, groups);
+  } catch(const std::bad_alloc&){
+    return ASSIGN_OUT_OF_MEMORY;
+  } catch(...){
+    return ASSIGN_FAILED;
+  }
+  return ASSIGN_OK;
+}
+
+int assign_solve(assign_workspace* workspace, const int* costs, unsigned int participants, unsigned int groups,
+                 int* assigned_groups, long long* total_cost)
+{
+  if(workspace == nullptr || (participants > 0 && (costs == nullptr || assigned_groups == nullptr))){
+    return ASSIGN_INVALID_ARGUMENT;
+  }
+  try {
+    const std::vector<assign::GroupId>& result = workspace->workspace.solve(costs, participants, groups);
+    std::copy(result.begin(), result.end(), assigned_groups);
+    if(total_cost != nullptr){
+      *total_cost = workspace->workspace.cost();
+    }
+  } catch(const std::bad_alloc&){
+    return ASSIGN_OUT_OF_MEMORY;
+  } catch(...){
+    return ASSIGN_FAILED;
+  }
+  return ASSIGN_OK;
+}
@@ -0,0 +1,80 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#ifndef ASSIGN_C_H
+#define ASSIGN_C_H
+
+/*
+ * C interface of libassign. A workspace keeps its buffers between solves, see SolverWorkspace.
+ * The functions do not throw and return one of the ASSIGN_* status codes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ASSIGN_ABI_VERSION 1
+
+enum {
+  ASSIGN_SOLVER_MUNKRES = 0,
+  ASSIGN_SOLVER_FLOW = 1,
+  ASSIGN_SOLVER_LAPJV = 2,
+  ASSIGN_SOLVER_AUCTION = 3,
+  ASSIGN_SOLVER_APPROX = 4
+};
+
+enum {
+  ASSIGN_OK = 0,
+  ASSIGN_INVALID_ARGUMENT = 1,
+  ASSIGN_OUT_OF_MEMORY = 2,
+  ASSIGN_FAILED = 3
+};
+
+typedef struct assign_workspace assign_workspace;
+
+/* ASSIGN_ABI_VERSION of the library */
+int assign_abi_version(void);
+
+/* returns NULL for an unknown solver or without memory. threads 0 uses all cores */
+assign_workspace* assign_workspace_create(int solver, unsigned int threads);
+void assign_workspace_destroy(assign_workspace* workspace);
+
+/* grows the buffers for solves up to this size in advance */
+int assign_workspace_reserve(assign_workspace* workspace, unsigned int participants, unsigned int groups);
+
+/*
+ * costs are row-major participants x groups. writes the group of every participant or -1 to
+ * assigned_groups and the total costs to total_cost when it is not NULL.
+ */
+int assign_solve(assign_workspace* workspace, const int* costs, unsigned int participants, unsigned int groups,
+                 int* assigned_groups, long long* total_cost);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ASSIGN_C_H */
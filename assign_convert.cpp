@@ -0,0 +1,122 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include "common.h"
+#include "binary.h"
+#include "output.h"
+
+using namespace assign;
+
+std::string read_next(int& i, int arg_num, char** args, const std::string& argname){
+  if(i+1 >= arg_num){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  ++i;
+  std::string value = args[i];
+  if(!value.empty() && value.at(0) == '-'){
+    ERROR(1, "Passed parameter " << argname << " without argument.");
+  }
+  return value;
+}
+
+void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
+  for(int i = 1; i < arg_num; ++i){
+    std::string arg = args[i];
+    if(arg == "--help" || arg == "-h"){
+      std::cout << "Converts csv preferences into the binary preferences format of binary.h which assign and\n"
+                << "assign_multiple map into memory instead of parsing. Binary input is converted back to csv.\n\n"
+                << "Usage: \n> assign_convert [parameters] < preferences.csv > preferences.bin\n\n"
+                << "Parameters:\n"
+                << "\t -h       | --help            \t print this message and leave.\n"
+                << "\t -i <arg> | --input <arg>     \t read from a file instead of stdin. binary input needs a file.\n"
+                << "\t -o <arg> | --output <arg>    \t write to a file instead of stdout.\n"
+                << std::endl;
+      std::exit(0);
+    } else if (arg == "--input" || arg == "-i"){
+      prog_args_dst["input"] = read_next(i, arg_num, args, arg);
+    } else if (arg == "--output" || arg == "-o"){
+      prog_args_dst["output"] = read_next(i, arg_num, args, arg);
+    } else {
+      ERROR(1,"Unknown command line parameter' " << arg);
+    }
+  }
+}
+
+void write_csv(const DensePreferences& preferences, std::ostream& stream){
+  BufferedWriter writer(stream);
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    writer.write(preferences.ids[participant]);
+    const Participant::Cost* row = preferences.row(participant);
+    for(uint group = 0; group < preferences.group_count; ++group){
+      writer.write(',');
+      writer.writeInteger(row[group]);
+    }
+    writer.write('\n');
+  }
+}
+
+int run(int arg_num, char** args) {
+
+  ProgArgs prog_args;
+  process_args(arg_num,args,prog_args);
+
+  const std::string input = prog_args["input"];
+  const std::string output = prog_args["output"];
+  std::ofstream file;
+  if(!output.empty()){
+    file.open(output.c_str(), std::ios::binary);
+    if(!file){
+      ERROR(1,"Could not open output file '" << output << "'.");
+    }
+  }
+  std::ostream& stream = output.empty() ? std::cout : file;
+
+  if(!input.empty() && is_binary_preferences(input)){
+    write_csv(DensePreferences::fromBinaryFile(input), stream);
+  } else {
+    auto preferences = input.empty() ? DensePreferences::fromCsv(std::cin) : DensePreferences::fromCsvFile(input);
+    write_binary_preferences(preferences, stream);
+  }
+  if(!stream){
+    ERROR(1,"Could not write the output.");
+  }
+  return 0;
+}
+
+int main(int arg_num, char** args) {
+  set_default_warning_stream(&std::cout);
+  try {
+    return run(arg_num, args);
+  } catch(const Error& error) {
+    std::cout << "ERROR: " << error.what() << std::endl;
+    return error.code();
+  }
+}
@@ -32,7 +32,12 @@
 #include <cstdlib>
 #include <cassert>
 #include <iostream>
+#include <memory>
 #include "common.h"
+#include "batch.h"
+#include "output.h"
+#include "stats.h"
+#include "cache.h"
 #include "munkres.h"
 #include "matrix.h"
 
@@ -68,9 +73,48 @@ void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
                 << "\t -m <arg> | --multiple <arg>  \t Assign participants to multiple groups. Splits the assignment multiple \n"
                 << "\t                              \t independent assignment problems. <arg> before which preference to split.\n"
                 << "\t                              \t counting from 0.\n"
-                << "\t                              \t integers determining where to split the preferences.\n"
+                << "\t                              \t a comma separated list (e.g. 2,5,9) of integers determining where to\n"
+                << "\t                              \t split the preferences. the assignments are solved in parallel.\n"
                 << "\t -x <arg> | --exclusive <arg> \t may be used in combination with -m to make assignments with mutualy \n"
-                << "\t                              \t exclusive groups.\n\n"
+                << "\t                              \t exclusive groups.\n"
+                << "\t -j       | --joint           \t with -x solve both assignments at once instead of one after\n"
+                << "\t                              \t the other. reports the costs, a lower bound on the optimal\n"
+                << "\t                              \t costs and the gap between them. always uses the flow solver.\n"
+                << "\t -n <arg> | --iterations <arg>\t iteration limit of --joint (default 100).\n"
+                << "\t -r <arg> | --refine-ms <arg> \t with -x improve the heuristic assignment by swapping\n"
+                << "\t                              \t participants for up to <arg> milliseconds on --threads.\n"
+                << "\t -R <arg> | --starts <arg>    \t with -x run <arg> randomized starts of the heuristic in\n"
+                << "\t                              \t parallel on --threads and keep the best one. the starts\n"
+                << "\t                              \t differ in layer order, tie breaking and penalties.\n"
+                << "\t -d <arg> | --seed <arg>      \t random seed of --starts (default 1). the same seed gives\n"
+                << "\t                              \t the same assignment on any number of threads.\n"
+                << "\t -C <arg> | --cache <arg>     \t keep results in the directory <arg>. equal preferences\n"
+                << "\t                              \t and options return the stored result, a single layer\n"
+                << "\t                              \t where few participants changed is repaired from it.\n"
+                << "\t -B       | --binary          \t write the assignment in the binary format of output.h\n"
+                << "\t                              \t instead of csv. --costs adds the costs. warnings go\n"
+                << "\t                              \t to stderr.\n"
+                << "\t -b       | --batch           \t solve many instances. each starts with a line '# <name>'\n"
+                << "\t                              \t or is a file in the --input directory. instances are\n"
+                << "\t                              \t solved in parallel on --threads and printed in input\n"
+                << "\t                              \t order behind their header line.\n"
+                << "\t -i <arg> | --input <arg>     \t read the preferences from a file instead of stdin. csv\n"
+                << "\t                              \t or binary preferences from assign_convert.\n"
+                << "\t -s <arg> | --solver <arg>    \t solver backend. one of: munkres (default), flow,\n"
+                << "\t                              \t lapjv, auction, approx. approx is a fast near-optimal\n"
+                << "\t                              \t assignment which reports its gap to a lower bound.\n"
+                << "\t -t <arg> | --threads <arg>   \t number of threads for parallel solvers. 0 (default) uses\n"
+                << "\t                              \t all cores.\n"
+                << "\t -l <arg> | --time-limit <arg>\t stop after <arg> milliseconds with the best assignment\n"
+                << "\t                              \t found so far. uses the auction solver and reports the\n"
+                << "\t                              \t costs, a lower bound and the gap when it is stopped.\n"
+                << "\t                              \t --joint stops its iterations at the limit.\n"
+                << "\t -v       | --verify          \t prove that the assignment is optimal with prices on the\n"
+                << "\t                              \t groups or report a lower bound and the gap to it.\n"
+                << "\t -q <arg> | --stats <arg>     \t write run statistics as json to the file <arg> or to\n"
+                << "\t                              \t stderr for 'stderr': time per phase, counters of the solvers,\n"
+                << "\t                              \t matrix dimensions, costs of the heuristic and memory.\n"
+                << "\t -Q <arg> | --trace <arg>     \t write the phases in the chrome trace format to <arg>.\n\n"
                 << "Example: \n> assign_multiple -e | assign_multiple -m 3 -x '0-0,2-1'\n"
                 << "  Will assign jack, jill, paul, mila and jenn to 3 groups from the first three preferences and two\n"
                 << "  groups from the other two preferences while preventing them from being in group combinations 0-0\n"
@@ -90,8 +134,49 @@ void process_args(int arg_num, char** args, ProgArgs& prog_args_dst){
     } else if (arg == "--exclusive" || arg == "-x"){
       std::string next = read_next(i, arg_num, args, arg);
       prog_args_dst["exclusive"] = next;
+    } else if (arg == "--joint" || arg == "-j"){
+      prog_args_dst["joint"] = "1";
+    } else if (arg == "--iterations" || arg == "-n"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["iterations"] = next;
+    } else if (arg == "--refine-ms" || arg == "-r"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["refine-ms"] = next;
+    } else if (arg == "--starts" || arg == "-R"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["starts"] = next;
+    } else if (arg == "--seed" || arg == "-d"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["seed"] = next;
+    } else if (arg == "--binary" || arg == "-B"){
+      prog_args_dst["binary"] = "1";
+    } else if (arg == "--batch" || arg == "-b"){
+      prog_args_dst["batch"] = "1";
     } else if (arg == "--costs" || arg == "-c"){
       prog_args_dst["costs"] = "1";
+    } else if (arg == "--input" || arg == "-i"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["input"] = next;
+    } else if (arg == "--solver" || arg == "-s"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["solver"] = next;
+    } else if (arg == "--time-limit" || arg == "-l"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["time-limit"] = next;
+    } else if (arg == "--verify" || arg == "-v"){
+      prog_args_dst["verify"] = "1";
+    } else if (arg == "--stats" || arg == "-q"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["stats"] = next;
+    } else if (arg == "--trace" || arg == "-Q"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["trace"] = next;
+    } else if (arg == "--cache" || arg == "-C"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["cache"] = next;
+    } else if (arg == "--threads" || arg == "-t"){
+      std::string next = read_next(i, arg_num, args, arg);
+      prog_args_dst["threads"] = next;
     } else {
       ERROR(1,"Unknown command line parameter' " << arg);
     }
@@ -123,13 +208,17 @@ std::vector<GroupId> create_assignments(const std::vector<Participant>& particip
   return result;
 }
 
-int main(int arg_num, char** args) {
+int run(int arg_num, char** args) {
 
 
   ProgArgs prog_args;
   process_args(arg_num,args,prog_args);
-
-  auto participants = Participant::fromCsv(std::cin);
+  if(!prog_args["binary"].empty()){ // keep the binary output clean
+    set_default_warning_stream(&std::cerr);
+  }
+  if(!prog_args["stats"].empty() || !prog_args["trace"].empty()){
+    enable_stats();
+  }
 
   std::vector<std::string> excludeStrings = split(prog_args["exclusive"],',');
   std::vector<std::pair<uint,uint>> exclude;
@@ -141,13 +230,61 @@ int main(int arg_num, char** args) {
     }
   }
 
-  auto split = parse<uint>(prog_args["multiple"]);
+  auto splits = parse_vector<uint>(split(prog_args["multiple"],','));
+  const std::string input = prog_args["input"];
 
-  Assignment problem(participants,split,exclude);
-  auto assignments = problem.solve();
+  if(!prog_args["batch"].empty()){
+    if(!prog_args["binary"].empty() || !prog_args["cache"].empty()){
+      ERROR(1, "--" << (prog_args["binary"].empty() ? "cache" : "binary") << " can not be combined with --batch.");
+    }
+    bool print_costs = !prog_args["costs"].empty();
+    SolverOptions options = parse_solver_options(prog_args);
+    uint threads = options.threads;
+    options.threads = 1; // the instances run in parallel instead
+    auto instances = input.empty() ? read_batch(std::cin) : read_batch(input);
+    run_batch(instances, [&](const BatchInstance& instance, std::ostream& output){
+      Assignment problem(instance.dense(),splits,exclude,options);
+      write_assignments_csv(problem.solveCompact(),print_costs,output);
+    }, threads, std::cout);
+    write_stats(prog_args["stats"], prog_args["trace"]);
+    return 0;
+  }
 
-  print_assignments_csv(assignments,!prog_args["costs"].empty());
+  DensePreferences preferences;
+  {
+    StatsPhase phase("read");
+    preferences = input.empty() ? DensePreferences::fromCsv(std::cin) : DensePreferences::fromFile(input);
+  }
+  AssignmentResult result;
+  std::unique_ptr<Assignment> problem;
+  {
+    StatsPhase phase("solve");
+    if(!prog_args["cache"].empty()){
+      result = ResultCache(prog_args["cache"],splits,exclude,parse_solver_options(prog_args)).solve(preferences);
+    } else {
+      problem.reset(new Assignment(std::move(preferences),splits,exclude,parse_solver_options(prog_args)));
+      result = problem->solveCompact();
+    }
+  }
+  {
+    StatsPhase phase("write");
+    if(!prog_args["binary"].empty()){
+      write_assignments_binary(result,!prog_args["costs"].empty());
+    } else {
+      write_assignments_csv(result,!prog_args["costs"].empty());
+    }
+  }
+  write_stats(prog_args["stats"], prog_args["trace"]);
 
   return 0;
 }
 
+int main(int arg_num, char** args) {
+  set_default_warning_stream(&std::cout);
+  try {
+    return run(arg_num, args);
+  } catch(const Error& error) {
+    std::cout << "ERROR: " << error.what() << std::endl;
+    return error.code();
+  }
+}
@@ -0,0 +1,323 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <limits>
+#include "auction.h"
+#include "thread_pool.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Price;
+
+const static Price NO_VALUE = std::numeric_limits<Price>::min() / 4;
+const static Price EPSILON_REDUCTION = 5;
+const static uint SEQUENTIAL_BIDS = 512; // below this bids are not worth waking the pool
+
+struct Bid {
+  GroupId group;
+  Price price;
+};
+
+class Auction {
+public:
+  Auction(const DensePreferences& preferences, uint group_size, ThreadPool& pool)
+    : m_Preferences(preferences), m_Pool(pool),
+      m_GroupCount(preferences.group_count), m_GroupSize(group_size),
+      m_Bidders(m_GroupCount * m_GroupSize), m_Scale(m_Bidders + 1),
+      m_Assigned(m_Bidders, -1), m_Prices(m_Bidders, 0), m_Owners(m_Bidders, -1), m_Slots(m_GroupCount),
+      m_Cheapest(m_GroupCount), m_Second(m_GroupCount), m_Bids(m_Bidders), m_Bucket(m_GroupCount + 1),
+      m_Evicted(m_GroupCount)
+  {
+    for(uint group = 0; group < m_GroupCount; ++group){
+      for(uint slot = group * m_GroupSize; slot < (group + 1) * m_GroupSize; ++slot){
+        m_Slots[group].push_back(slot);
+      }
+    }
+  }
+
+  AuctionResult solve(std::chrono::steady_clock::time_point deadline, const AuctionProgress& progress){
+    m_Deadline = deadline;
+    AuctionResult result;
+    result.groups = greedy();
+    result.cost = totalCost(result.groups);
+    result.lower_bound = lowerBound();
+    if(progress) progress(result);
+
+    Participant::Cost min_cost = 0, max_cost = 0;
+    for(std::size_t index = 0; index < m_Preferences.cost_count(); ++index){
+      min_cost = std::min(min_cost, m_Preferences.data()[index]);
+      max_cost = std::max(max_cost, m_Preferences.data()[index]);
+    }
+    Price epsilon = std::max<Price>(1, (max_cost - min_cost) * m_Scale / EPSILON_REDUCTION);
+    while(result.cost > result.lower_bound && runPhase(epsilon)){
+      std::vector<GroupId> groups(m_Preferences.size(), -1);
+      for(uint participant = 0; participant < m_Preferences.size(); ++participant){
+        groups[participant] = m_Assigned[participant] / m_GroupSize;
+      }
+      long long cost = totalCost(groups);
+      result.lower_bound = std::max(result.lower_bound, epsilon == 1 ? cost : lowerBound());
+      if(cost < result.cost || epsilon == 1){
+        result.groups.swap(groups);
+        result.cost = cost;
+        if(progress) progress(result);
+      }
+      if(epsilon == 1) break;
+      epsilon = std::max<Price>(1, epsilon / EPSILON_REDUCTION);
+    }
+    return result;
+  }
+
+private:
+  Price cost(uint bidder, uint group) const { // scaled. bidders beyond the participants fill empty slots
+    return bidder < m_Preferences.size() ? m_Preferences.row(bidder)[group] * m_Scale : 0;
+  }
+
+  Price price(uint group, uint position) const {
+    return position < m_Slots[group].size() ? m_Prices[m_Slots[group][position]] : -NO_VALUE;
+  }
+
+  // slots of a group are kept in a min heap on their prices
+  bool moreExpensive(uint slot, uint other) const {
+    return m_Prices[slot] > m_Prices[other];
+  }
+
+  // every participant takes the cheapest group with a free place
+  std::vector<GroupId> greedy() const {
+    std::vector<GroupId> result(m_Preferences.size(), -1);
+    std::vector<uint> free(m_GroupCount, m_GroupSize);
+    for(uint participant = 0; participant < m_Preferences.size(); ++participant){
+      const Participant::Cost* row = m_Preferences.row(participant);
+      for(uint group = 0; group < m_GroupCount; ++group){
+        if(free[group] > 0 && (result[participant] < 0 || row[group] < row[result[participant]])){
+          result[participant] = group;
+        }
+      }
+      --free[result[participant]];
+    }
+    return result;
+  }
+
+  long long totalCost(const std::vector<GroupId>& groups) const {
+    long long result = 0;
+    for(uint participant = 0; participant < m_Preferences.size(); ++participant){
+      result += m_Preferences.row(participant)[groups[participant]];
+    }
+    return result;
+  }
+
+  // dual value of the prices: every bidder at its cheapest slot including the price minus all prices
+  long long lowerBound() const {
+    Price total = 0;
+    Price cheapest = -NO_VALUE;
+    for(uint group = 0; group < m_GroupCount; ++group){
+      cheapest = std::min(cheapest, price(group, 0));
+      for(uint position = 0; position < m_Slots[group].size(); ++position){
+        total -= price(group, position);
+      }
+    }
+    for(uint bidder = 0; bidder < m_Bidders; ++bidder){
+      Price best = -NO_VALUE;
+      if(bidder >= m_Preferences.size()){
+        best = cheapest;
+      } else {
+        for(uint group = 0; group < m_GroupCount; ++group){
+          best = std::min(best, cost(bidder, group) + price(group, 0));
+        }
+      }
+      total += best;
+    }
+    return total >= 0 ? (total + m_Scale - 1) / m_Scale : -(-total / m_Scale);
+  }
+
+  // false when the deadline passed before all bidders were assigned
+  bool runPhase(Price epsilon){
+    std::fill(m_Assigned.begin(), m_Assigned.end(), -1);
+    std::fill(m_Owners.begin(), m_Owners.end(), -1);
+    std::vector<uint> unassigned(m_Bidders);
+    for(uint bidder = 0; bidder < m_Bidders; ++bidder){
+      unassigned[bidder] = bidder;
+    }
+    add_counter("auction.phases", 1);
+    long long rounds = 0, bids = 0;
+    while(!unassigned.empty()){
+      if(std::chrono::steady_clock::now() >= m_Deadline){
+        add_counter("auction.rounds", rounds);
+        add_counter("auction.bids", bids);
+        return false;
+      }
+      ++rounds;
+      bids += unassigned.size();
+      for(uint group = 0; group < m_GroupCount; ++group){
+        m_Cheapest[group] = price(group, 0);
+        m_Second[group] = std::min(price(group, 1), price(group, 2));
+      }
+      forEach(unassigned.size(), [&](uint begin, uint end){
+        for(uint i = begin; i < end; ++i){
+          m_Bids[i] = bid(unassigned[i], epsilon);
+        }
+      });
+      // bucket the bids by group
+      std::fill(m_Bucket.begin(), m_Bucket.end(), 0);
+      for(uint i = 0; i < unassigned.size(); ++i){
+        ++m_Bucket[m_Bids[i].group + 1];
+      }
+      for(uint group = 0; group < m_GroupCount; ++group){
+        m_Bucket[group + 1] += m_Bucket[group];
+      }
+      std::vector<uint> order(unassigned.size());
+      std::vector<uint> position(m_Bucket.begin(), m_Bucket.end() - 1);
+      for(uint i = 0; i < unassigned.size(); ++i){
+        order[position[m_Bids[i].group]++] = i;
+      }
+      forEach(m_GroupCount, [&](uint begin, uint end){
+        for(uint group = begin; group < end; ++group){
+          resolve(group, epsilon, unassigned, order);
+        }
+      });
+      std::vector<uint> next;
+      for(uint bidder : unassigned){
+        if(m_Assigned[bidder] < 0) next.push_back(bidder);
+      }
+      for(std::vector<uint>& evicted : m_Evicted){
+        next.insert(next.end(), evicted.begin(), evicted.end());
+        evicted.clear();
+      }
+      unassigned.swap(next);
+    }
+    add_counter("auction.rounds", rounds);
+    add_counter("auction.bids", bids);
+    return true;
+  }
+
+  Bid bid(uint bidder, Price epsilon) const {
+    Price best = NO_VALUE, second = NO_VALUE;
+    uint best_group = 0;
+    for(uint group = 0; group < m_GroupCount; ++group){
+      Price value = -cost(bidder, group) - m_Cheapest[group];
+      if(value > best){
+        second = best;
+        best = value;
+        best_group = group;
+      } else if(value > second){
+        second = value;
+      }
+    }
+    if(m_Second[best_group] != -NO_VALUE){
+      second = std::max(second, -cost(bidder, best_group) - m_Second[best_group]);
+    }
+    Bid result;
+    result.group = best_group;
+    result.price = m_Cheapest[best_group] + epsilon + (second == NO_VALUE ? 0 : best - second);
+    return result;
+  }
+
+  // the highest bids get the cheapest slots as long as they raise the price
+  void resolve(uint group, Price epsilon, const std::vector<uint>& unassigned, std::vector<uint>& order){
+    uint begin = m_Bucket[group], end = m_Bucket[group + 1];
+    if(begin == end) return;
+    std::sort(order.begin() + begin, order.begin() + end, [&](uint a, uint b){
+      return m_Bids[a].price != m_Bids[b].price ? m_Bids[a].price > m_Bids[b].price : unassigned[a] < unassigned[b];
+    });
+    std::vector<uint>& heap = m_Slots[group];
+    auto compare = [this](uint a, uint b){ return moreExpensive(a, b); };
+    uint raised = 0;
+    for(uint i = begin; i < end && raised < heap.size(); ++i){
+      uint slot = heap.front();
+      const Bid& bid = m_Bids[order[i]];
+      if(bid.price < m_Prices[slot] + epsilon) break;
+      std::pop_heap(heap.begin(), heap.end() - raised, compare);
+      ++raised;
+      if(m_Owners[slot] >= 0){
+        m_Assigned[m_Owners[slot]] = -1;
+        m_Evicted[group].push_back(m_Owners[slot]);
+      }
+      uint bidder = unassigned[order[i]];
+      m_Owners[slot] = bidder;
+      m_Assigned[bidder] = slot;
+      m_Prices[slot] = bid.price;
+    }
+    for(uint i = raised; i > 0; --i){
+      std::push_heap(heap.begin(), heap.end() - i + 1, compare);
+    }
+  }
+
+  template<typename Task>
+  void forEach(uint count, const Task& task){
+    if(count < SEQUENTIAL_BIDS){
+      task(0, count);
+    } else {
+      m_Pool.parallel_for(count, task);
+    }
+  }
+
+  const DensePreferences& m_Preferences;
+  ThreadPool& m_Pool;
+  const uint m_GroupCount;
+  const uint m_GroupSize;
+  const uint m_Bidders;
+  const Price m_Scale;
+  std::vector<int> m_Assigned;                // slot of every bidder
+  std::vector<Price> m_Prices;                // price of every slot
+  std::vector<int> m_Owners;                  // bidder of every slot
+  std::vector<std::vector<uint>> m_Slots;     // min heap of slots per group
+  std::vector<Price> m_Cheapest;
+  std::vector<Price> m_Second;
+  std::vector<Bid> m_Bids;
+  std::vector<uint> m_Bucket;
+  std::vector<std::vector<uint>> m_Evicted;
+  std::chrono::steady_clock::time_point m_Deadline;
+};
+
+} // namespace
+
+std::vector<GroupId> assign::auction_assignment(const DensePreferences& preferences, uint group_size,
+                                                uint threads)
+{
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    return std::vector<GroupId>(preferences.size(), -1);
+  }
+  ThreadPool pool(threads);
+  Auction auction(preferences, group_size, pool);
+  return auction.solve(std::chrono::steady_clock::time_point::max(), AuctionProgress()).groups;
+}
+
+AuctionResult assign::auction_assignment(const DensePreferences& preferences, uint group_size, uint threads,
+                                         std::chrono::steady_clock::time_point deadline,
+                                         const AuctionProgress& progress)
+{
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    AuctionResult result;
+    result.groups.assign(preferences.size(), -1);
+    return result;
+  }
+  ThreadPool pool(threads);
+  Auction auction(preferences, group_size, pool);
+  return auction.solve(deadline, progress);
+}
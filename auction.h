@@ -0,0 +1,68 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <functional>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Bertsekas' auction algorithm for the assignment with groups of group_size similar slots.
+ *
+ * All unassigned participants bid in parallel against the same prices (Jacobi) on a pool of
+ * threads. The bids are resolved per group. Costs are scaled by the number of bidders + 1 and
+ * epsilon is reduced down to 1 over several phases, so the result is optimal for the integer
+ * costs. The result does not depend on the number of threads. threads == 0 uses all cores.
+ *
+ * Returns the assigned group for every participant.
+ */
+std::vector<GroupId> auction_assignment(const DensePreferences& preferences, uint group_size,
+                                        uint threads);
+
+struct AuctionResult {
+  std::vector<GroupId> groups;
+  long long cost = 0;
+  long long lower_bound = 0; // no assignment is cheaper, equal to cost when optimal
+};
+
+typedef std::function<void(const AuctionResult&)> AuctionProgress;
+
+/**
+ * Anytime version of the auction. Starts from a greedy assignment and takes the assignment of every
+ * finished epsilon phase when it is cheaper. The lower bound comes from the slot prices. Stops at the
+ * deadline, in the middle of a phase when necessary, and returns the best assignment so far.
+ * progress is called with every improvement.
+ */
+AuctionResult auction_assignment(const DensePreferences& preferences, uint group_size, uint threads,
+                                 std::chrono::steady_clock::time_point deadline,
+                                 const AuctionProgress& progress = AuctionProgress());
+
+} // namespace assign
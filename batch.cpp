@@ -0,0 +1,170 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <mutex>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "batch.h"
+#include "csv.h"
+#include "thread_pool.h"
+
+using namespace assign;
+
+namespace {
+
+bool is_directory(const std::string& path){
+  struct stat status;
+  return stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+std::size_t instance_size(const BatchInstance& instance){
+  if(instance.path.empty()){
+    return instance.csv.size();
+  }
+  struct stat status;
+  return stat(instance.path.c_str(), &status) == 0 ? status.st_size : 0;
+}
+
+// collects the lines of every instance behind its header line
+class BatchParser {
+public:
+  BatchParser(std::vector<BatchInstance>& dst) : m_Instances(dst) {}
+
+  void operator()(const char* begin, const char* end, unsigned int){
+    const char* content = begin;
+    const char* content_end = end;
+    trim(content, content_end);
+    if(content < content_end && *content == '#'){
+      ++content;
+      trim(content, content_end);
+      m_Instances.push_back(BatchInstance());
+      m_Instances.back().name.assign(content, content_end);
+      return;
+    }
+    if(content == content_end) return; // skip empty lines
+    if(m_Instances.empty()){ // lines without header
+      m_Instances.push_back(BatchInstance());
+    }
+    std::string& csv = m_Instances.back().csv;
+    csv.append(begin, end);
+    csv.push_back('\n');
+  }
+
+private:
+  std::vector<BatchInstance>& m_Instances;
+};
+
+} // namespace
+
+DensePreferences BatchInstance::dense() const {
+  if(!path.empty()){
+    return DensePreferences::fromFile(path);
+  }
+  std::istringstream stream(csv);
+  return DensePreferences::fromCsv(stream);
+}
+
+SparsePreferences BatchInstance::sparse(uint group_count) const {
+  if(!path.empty()){
+    return SparsePreferences::fromCsvFile(path, group_count);
+  }
+  std::istringstream stream(csv);
+  return SparsePreferences::fromCsv(stream, group_count);
+}
+
+std::vector<BatchInstance> assign::read_batch(std::istream& stream){
+  std::vector<BatchInstance> result;
+  read_csv_lines(stream, BatchParser(result));
+  return result;
+}
+
+std::vector<BatchInstance> assign::read_batch(const std::string& path){
+  std::vector<BatchInstance> result;
+  if(!is_directory(path)){
+    read_csv_lines(path, BatchParser(result));
+    return result;
+  }
+  DIR* directory = opendir(path.c_str());
+  if(directory == nullptr){
+    ERROR(1,"Could not open input directory '" << path << "'.");
+  }
+  while(dirent* entry = readdir(directory)){
+    std::string name = entry->d_name;
+    if(name.empty() || name[0] == '.' || is_directory(path + "/" + name)) continue;
+    result.push_back(BatchInstance());
+    result.back().name = name;
+    result.back().path = path + "/" + name;
+  }
+  closedir(directory);
+  std::sort(result.begin(), result.end(), [](const BatchInstance& a, const BatchInstance& b){
+    return a.name < b.name;
+  });
+  return result;
+}
+
+void assign::run_batch(const std::vector<BatchInstance>& instances, const InstanceTask& task, uint threads,
+                       std::ostream& output)
+{
+  // large instances first so that no thread is left with a big one at the end
+  std::vector<std::size_t> sizes(instances.size());
+  std::vector<uint> order(instances.size());
+  for(uint i = 0; i < instances.size(); ++i){
+    sizes[i] = instance_size(instances[i]);
+  }
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&sizes](uint a, uint b){ return sizes[a] > sizes[b]; });
+
+  std::vector<std::unique_ptr<std::string>> outputs(instances.size());
+  std::mutex mutex;
+  uint written = 0;
+  ThreadPool pool(threads);
+  pool.parallel_for(instances.size(), [&](uint begin, uint end){
+    for(uint i = begin; i < end; ++i){
+      uint instance = order[i];
+      std::ostringstream stream;
+      stream << "# " << instances[instance].name << "\n";
+      set_warning_stream(&stream);
+      try {
+        task(instances[instance], stream);
+      } catch(const std::exception& error) { // a broken instance does not stop the others
+        stream << "ERROR: " << error.what() << "\n";
+      }
+      set_warning_stream(nullptr);
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[instance].reset(new std::string(stream.str()));
+      for(; written < outputs.size() && outputs[written]; ++written){
+        output.write(outputs[written]->data(), outputs[written]->size());
+        outputs[written].reset();
+      }
+    }
+  }, 1);
+  output.flush();
+}
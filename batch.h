@@ -0,0 +1,67 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * One of many independent assignment problems read at once. Batches are either a csv source where
+ * every instance starts with a header line '# <name>' or a directory with one csv file per instance.
+ */
+struct BatchInstance {
+  std::string name;
+  std::string path; // file of the instance, csv is used when empty
+  std::string csv;
+
+  DensePreferences dense() const;
+  SparsePreferences sparse(uint group_count = 0) const;
+};
+
+std::vector<BatchInstance> read_batch(std::istream& stream);
+// directories are read as one instance per file, files as a header separated csv
+std::vector<BatchInstance> read_batch(const std::string& path);
+
+// writes the output of one instance into the passed stream
+typedef std::function<void(const BatchInstance& instance, std::ostream& output)> InstanceTask;
+
+/**
+ * Runs the task for all instances on threads (0: all cores). Idle threads take the next instance,
+ * largest first. Warnings and errors of an instance end up in its output. The outputs are written to
+ * output in input order as soon as they are complete, each behind the header line of its instance.
+ */
+void run_batch(const std::vector<BatchInstance>& instances, const InstanceTask& task, uint threads,
+               std::ostream& output);
+
+} // namespace assign
@@ -0,0 +1,185 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binary.h"
+#include "output.h"
+
+using namespace assign;
+
+namespace {
+
+const static std::size_t HEADER_SIZE = 32;
+
+bool little_endian(){
+  const unsigned int one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+unsigned long long read_unsigned(const unsigned char* bytes, uint width){
+  unsigned long long result = 0;
+  for(uint byte = 0; byte < width; ++byte){
+    result |= (unsigned long long) bytes[byte] << (8 * byte);
+  }
+  return result;
+}
+
+long long read_signed(const unsigned char* bytes, uint width){
+  unsigned long long value = read_unsigned(bytes, width);
+  unsigned long long sign = 1ull << (8 * width - 1);
+  return (long long) (value ^ sign) - (long long) sign;
+}
+
+std::size_t padded(std::size_t size){
+  return (size + 7) / 8 * 8;
+}
+
+// read only mapping of a whole file, unmapped with the last reference
+class MappedFile {
+public:
+  explicit MappedFile(const std::string& path){
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0){
+      ERROR(1,"Could not open input file '" << path << "'.");
+    }
+    struct stat status;
+    if(fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0){
+      m_Size = status.st_size;
+      m_Data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if(m_Data == MAP_FAILED){
+      ERROR(1,"Could not map input file '" << path << "'.");
+    }
+  }
+  ~MappedFile(){
+    munmap(m_Data, m_Size);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data() const { return static_cast<const unsigned char*>(m_Data); }
+  std::size_t size() const { return m_Size; }
+
+private:
+  void* m_Data = MAP_FAILED;
+  std::size_t m_Size = 0;
+};
+
+} // namespace
+
+bool assign::is_binary_preferences(const std::string& path){
+  std::ifstream stream(path.c_str(), std::ios::binary);
+  char magic[4];
+  return stream.read(magic, 4) && std::memcmp(magic, BINARY_PREFERENCES_MAGIC, 4) == 0;
+}
+
+void assign::write_binary_preferences(const DensePreferences& preferences, std::ostream& stream){
+  std::size_t table = 0;
+  for(const Participant::Id& id : preferences.ids){
+    table += 4 + id.size();
+  }
+  BufferedWriter writer(stream);
+  writer.write(BINARY_PREFERENCES_MAGIC, 4);
+  writer.writeInt32(BINARY_PREFERENCES_VERSION);
+  writer.writeInt32(preferences.size());
+  writer.writeInt32(preferences.group_count);
+  writer.writeInt32(sizeof(Participant::Cost));
+  writer.writeInt32(0);
+  writer.writeInt32((int) (table & 0xffffffffu));
+  writer.writeInt32((int) (table >> 16 >> 16));
+  for(const Participant::Id& id : preferences.ids){
+    writer.writeInt32(id.size());
+    writer.write(id);
+  }
+  for(std::size_t padding = table; padding < padded(table); ++padding){
+    writer.write('\0');
+  }
+  for(std::size_t index = 0; index < preferences.cost_count(); ++index){
+    writer.writeInt32(preferences.data()[index]);
+  }
+}
+
+DensePreferences DensePreferences::fromBinaryFile(const std::string& path){
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+  const unsigned char* data = file->data();
+  if(file->size() < HEADER_SIZE || std::memcmp(data, BINARY_PREFERENCES_MAGIC, 4) != 0){
+    ERROR(1,"'" << path << "' is no binary preferences file.");
+  }
+  uint version = read_unsigned(data + 4, 4);
+  if(version != BINARY_PREFERENCES_VERSION){
+    ERROR(1,"Binary preferences file '" << path << "' has the unsupported version " << version << ".");
+  }
+  uint participants = read_unsigned(data + 8, 4);
+  uint groups = read_unsigned(data + 12, 4);
+  uint width = read_unsigned(data + 16, 4);
+  std::size_t table = read_unsigned(data + 24, 8);
+  if(width != 1 && width != 2 && width != 4){
+    ERROR(1,"Binary preferences file '" << path << "' has the unsupported cost width " << width << ".");
+  }
+  std::size_t begin = HEADER_SIZE + padded(table);
+  std::size_t count = (std::size_t) participants * groups;
+  if(table > file->size() || begin + count * width != file->size()){
+    ERROR(1,"Binary preferences file '" << path << "' is truncated or has a wrong size.");
+  }
+
+  DensePreferences result;
+  result.group_count = groups;
+  result.ids.reserve(participants);
+  const unsigned char* cursor = data + HEADER_SIZE;
+  const unsigned char* end = cursor + table;
+  for(uint participant = 0; participant < participants; ++participant){
+    std::size_t length = cursor + 4 <= end ? read_unsigned(cursor, 4) : table;
+    if(cursor + 4 + length > end){
+      ERROR(1,"Id table of binary preferences file '" << path << "' is broken at participant #"
+               << participant << ".");
+    }
+    result.ids.push_back(Participant::Id(reinterpret_cast<const char*>(cursor + 4), length));
+    cursor += 4 + length;
+  }
+  const unsigned char* costs = data + begin;
+  if(width == sizeof(Participant::Cost) && little_endian()){
+    madvise(const_cast<unsigned char*>(data), file->size(), MADV_WILLNEED);
+    result.mapped = reinterpret_cast<const Participant::Cost*>(costs);
+    result.mapping = file;
+  } else {
+    result.costs.resize(count);
+    for(std::size_t index = 0; index < count; ++index){
+      result.costs[index] = read_signed(costs + index * width, width);
+    }
+  }
+  return result;
+}
+
+DensePreferences DensePreferences::fromFile(const std::string& path){
+  return is_binary_preferences(path) ? fromBinaryFile(path) : fromCsvFile(path);
+}
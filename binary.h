@@ -0,0 +1,62 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Binary preferences file. All numbers are little endian.
+ *
+ *   offset  size
+ *        0     4  "ASGP"
+ *        4     4  version, 1
+ *        8     4  participants
+ *       12     4  groups
+ *       16     4  cost width in bytes: 1, 2 or 4, signed
+ *       20     4  0
+ *       24     8  size of the id table in bytes
+ *       32        id table: per participant a 4 byte length and the id bytes
+ *                 zero bytes up to the next multiple of 8
+ *                 row-major participants x groups costs
+ *
+ * Costs of width 4 are mapped and used by the solvers without copying on little endian machines.
+ */
+const static char BINARY_PREFERENCES_MAGIC[4] = { 'A', 'S', 'G', 'P' };
+const static unsigned int BINARY_PREFERENCES_VERSION = 1;
+
+// whether the file starts with the magic of a binary preferences file
+bool is_binary_preferences(const std::string& path);
+
+// writes the preferences with costs of width 4
+void write_binary_preferences(const DensePreferences& preferences, std::ostream& stream);
+
+} // namespace assign
@@ -0,0 +1,433 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "certificate.h"
+#include "incremental.h"
+#include "output.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+/**
+ * Cache entry, all numbers little endian:
+ *   "ASGC", version (1), flags (1: prices), layers, participants, groups as 4 bytes each, the
+ *   8 byte hash of the preferences, per participant a 4 byte length and the id bytes, the row-major
+ *   participants x groups costs, the groups and the costs of the result as 4 bytes each and with
+ *   the prices flag the price of every group as 8 bytes.
+ */
+const static char CACHE_MAGIC[4] = { 'A', 'S', 'G', 'C' };
+const static uint CACHE_VERSION = 1;
+// entries kept per options, the least recently used ones are removed
+const static uint CACHE_ENTRIES = 8;
+
+typedef unsigned long long Hash;
+
+// FNV-1a over whole values instead of bytes
+class Hasher {
+public:
+  void add(unsigned long long value){ m_Hash = (m_Hash ^ value) * 0x100000001b3ull; }
+  void add(const std::string& text){
+    add(text.size());
+    for(char character : text){
+      add((unsigned char) character);
+    }
+  }
+  Hash hash() const { return m_Hash; }
+
+private:
+  Hash m_Hash = 0xcbf29ce484222325ull;
+};
+
+Hash preferencesHash(const DensePreferences& preferences){
+  Hasher hasher;
+  hasher.add(preferences.size());
+  hasher.add(preferences.group_count);
+  for(const Participant::Id& id : preferences.ids){
+    hasher.add(id);
+  }
+  const Participant::Cost* costs = preferences.data();
+  for(std::size_t index = 0; index < preferences.cost_count(); ++index){
+    hasher.add((unsigned int) costs[index]);
+  }
+  return hasher.hash();
+}
+
+bool samePreferences(const DensePreferences& first, const DensePreferences& second){
+  return first.group_count == second.group_count && first.ids == second.ids
+      && std::equal(first.data(), first.data() + first.cost_count(), second.data());
+}
+
+bool sameRow(const DensePreferences& first, uint first_index, const DensePreferences& second, uint second_index){
+  return std::equal(first.row(first_index), first.row(first_index) + first.group_count, second.row(second_index));
+}
+
+struct Entry {
+  Hash hash = 0;
+  DensePreferences preferences;
+  uint layers = 0;
+  std::vector<GroupId> groups;
+  std::vector<Participant::Cost> costs;
+  std::vector<long long> prices; // empty without a proof of optimality
+};
+
+bool littleEndian(){
+  const unsigned int one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+class Reader {
+public:
+  explicit Reader(const std::vector<char>& data) : m_Data(data) {}
+
+  bool read(uint width, unsigned long long& value){
+    if(m_Position + width > m_Data.size()){
+      return false;
+    }
+    value = 0;
+    for(uint byte = 0; byte < width; ++byte){
+      value |= (unsigned long long) (unsigned char) m_Data[m_Position + byte] << (8 * byte);
+    }
+    m_Position += width;
+    return true;
+  }
+  bool read(std::size_t size, std::string& text){
+    if(m_Position + size > m_Data.size()){
+      return false;
+    }
+    text.assign(m_Data.data() + m_Position, size);
+    m_Position += size;
+    return true;
+  }
+  bool readInts(std::size_t count, std::vector<int>& values){
+    if(count > remaining() / 4){ // before allocating for a count of a broken file
+      return false;
+    }
+    values.resize(count);
+    if(littleEndian()){
+      std::memcpy(values.data(), m_Data.data() + m_Position, count * 4);
+      m_Position += count * 4;
+      return true;
+    }
+    unsigned long long value = 0;
+    for(std::size_t index = 0; index < count; ++index){
+      if(!read(4, value)) return false;
+      values[index] = (int) (unsigned int) value;
+    }
+    return true;
+  }
+  std::size_t remaining() const { return m_Data.size() - m_Position; }
+  bool done() const { return m_Position == m_Data.size(); }
+
+private:
+  const std::vector<char>& m_Data;
+  std::size_t m_Position = 0;
+};
+
+// false for missing, broken or outdated entries
+bool readEntry(const std::string& path, Entry& entry){
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  std::streamoff size = file ? (std::streamoff) file.tellg() : -1;
+  if(size < 0){
+    return false;
+  }
+  std::vector<char> data((std::size_t) size);
+  file.seekg(0);
+  if(!file.read(data.data(), data.size())){
+    return false;
+  }
+  Reader reader(data);
+  std::string magic;
+  unsigned long long version, flags, layers, participants, groups, length;
+  if(!reader.read(4, magic) || magic != std::string(CACHE_MAGIC, 4) || !reader.read(4, version)
+     || version != CACHE_VERSION || !reader.read(4, flags) || !reader.read(4, layers)
+     || !reader.read(4, participants) || !reader.read(4, groups) || !reader.read(8, entry.hash)){
+    return false;
+  }
+  // every id takes at least its length, every price 8 bytes
+  if(participants > reader.remaining() / 4 || ((flags & 1) && groups > reader.remaining() / 8)){
+    return false;
+  }
+  entry.layers = layers;
+  entry.preferences.group_count = groups;
+  entry.preferences.ids.resize(participants);
+  for(Participant::Id& id : entry.preferences.ids){
+    if(!reader.read(4, length) || !reader.read(length, id)) return false;
+  }
+  if(!reader.readInts((std::size_t) participants * groups, entry.preferences.costs)
+     || !reader.readInts((std::size_t) participants * layers, entry.groups)
+     || !reader.readInts((std::size_t) participants * layers, entry.costs)){
+    return false;
+  }
+  if(flags & 1){
+    entry.prices.resize(groups);
+    for(long long& price : entry.prices){
+      unsigned long long value;
+      if(!reader.read(8, value)) return false;
+      price = (long long) value;
+    }
+  }
+  return reader.done();
+}
+
+// written next to the file and renamed, readers never see half a file
+template<typename Write>
+void replaceFile(const std::string& path, const Write& write){
+  std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary);
+    if(!file){
+      WARNING("Could not write the cache file '" << temporary << "'.");
+      return;
+    }
+    write(file);
+  }
+  if(std::rename(temporary.c_str(), path.c_str()) != 0){
+    std::remove(temporary.c_str());
+    WARNING("Could not write the cache file '" << path << "'.");
+  }
+}
+
+void writeEntry(const std::string& path, Hash hash, const DensePreferences& preferences,
+                const AssignmentResult& result, const std::vector<long long>& prices)
+{
+  replaceFile(path, [&](std::ofstream& file){
+    BufferedWriter writer(file);
+    writer.write(CACHE_MAGIC, 4);
+    writer.writeInt32(CACHE_VERSION);
+    writer.writeInt32(prices.empty() ? 0 : 1);
+    writer.writeInt32(result.layers);
+    writer.writeInt32(preferences.size());
+    writer.writeInt32(preferences.group_count);
+    writer.writeInt32((int) (hash & 0xffffffffu));
+    writer.writeInt32((int) (hash >> 32));
+    for(const Participant::Id& id : preferences.ids){
+      writer.writeInt32(id.size());
+      writer.write(id);
+    }
+    const Participant::Cost* costs = preferences.data();
+    for(std::size_t index = 0; index < preferences.cost_count(); ++index){
+      writer.writeInt32(costs[index]);
+    }
+    for(GroupId group : result.groups){
+      writer.writeInt32(group);
+    }
+    for(Participant::Cost cost : result.costs){
+      writer.writeInt32(cost);
+    }
+    for(long long price : prices){
+      writer.writeInt32((int) ((unsigned long long) price & 0xffffffffu));
+      writer.writeInt32((int) ((unsigned long long) price >> 32));
+    }
+  });
+}
+
+// names of the entries of the options of the index, most recently used first
+std::vector<std::string> readIndex(const std::string& path){
+  std::ifstream file(path);
+  std::vector<std::string> names;
+  std::string name;
+  while(std::getline(file, name)){
+    if(!name.empty() && name.find('/') == std::string::npos){
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+// moves name to the front and removes the entries beyond CACHE_ENTRIES
+void useEntry(const std::string& directory, const std::string& path, const std::string& name){
+  std::vector<std::string> names = readIndex(path);
+  names.erase(std::remove(names.begin(), names.end(), name), names.end());
+  names.insert(names.begin(), name);
+  for(uint index = CACHE_ENTRIES; index < names.size(); ++index){
+    std::remove((directory + "/" + names[index]).c_str());
+  }
+  names.resize(std::min<std::size_t>(names.size(), CACHE_ENTRIES));
+  replaceFile(path, [&](std::ofstream& file){
+    for(const std::string& entry : names){
+      file << entry << "\n";
+    }
+  });
+}
+
+// the stored assignment with its prices as the start of an incremental assignment which applies
+// the changed participants. false when too many changed or the entry can not be repaired
+bool repair(const Entry& entry, const DensePreferences& preferences, AssignmentResult& result,
+            std::vector<long long>& prices)
+{
+  if(entry.layers != 1 || entry.prices.empty() || entry.preferences.group_count != preferences.group_count){
+    return false;
+  }
+  std::unordered_map<Participant::Id,uint> stored;
+  for(uint i = 0; i < entry.preferences.size(); ++i){
+    if(!stored.insert(std::make_pair(entry.preferences.ids[i], i)).second) return false;
+  }
+  std::unordered_map<Participant::Id,uint> current;
+  std::vector<uint> updated, added;
+  for(uint i = 0; i < preferences.size(); ++i){
+    if(!current.insert(std::make_pair(preferences.ids[i], i)).second) return false;
+    auto found = stored.find(preferences.ids[i]);
+    if(found == stored.end()){
+      added.push_back(i);
+    } else if(!sameRow(entry.preferences, found->second, preferences, i)){
+      updated.push_back(i);
+    }
+  }
+  std::vector<Participant::Id> removed;
+  for(const Participant::Id& id : entry.preferences.ids){
+    if(!current.count(id)){
+      removed.push_back(id);
+    }
+  }
+  std::size_t changes = removed.size() + updated.size() + added.size();
+  if(changes > std::max(entry.preferences.size(), preferences.size()) / 4){
+    return false;
+  }
+  IncrementalAssignment assignment(preferences.group_count);
+  if(!assignment.seed(entry.preferences, entry.groups, entry.prices)){
+    return false;
+  }
+  auto row = [&](uint i){
+    return std::vector<Participant::Cost>(preferences.row(i), preferences.row(i) + preferences.group_count);
+  };
+  for(const Participant::Id& id : removed){
+    assignment.remove(id);
+  }
+  for(uint i : updated){
+    assignment.update(preferences.ids[i], row(i));
+  }
+  for(uint i : added){
+    assignment.add(preferences.ids[i], row(i));
+  }
+  result = AssignmentResult();
+  result.ids = &preferences.ids;
+  result.layers = 1;
+  result.groups.resize(preferences.size());
+  result.costs.resize(preferences.size());
+  for(uint i = 0; i < preferences.size(); ++i){
+    result.groups[i] = assignment.group(preferences.ids[i]);
+    result.costs[i] = preferences.row(i)[result.groups[i]];
+  }
+  prices = assignment.prices();
+  add_counter("cache.repaired", changes);
+  return true;
+}
+
+} // namespace
+
+ResultCache::ResultCache(const std::string& directory, const std::vector<uint>& splits,
+                         const std::vector<std::pair<uint,uint>>& forbidden, const SolverOptions& options)
+  : m_Directory(directory), m_Splits(splits), m_Forbidden(forbidden), m_Options(options)
+{}
+
+AssignmentResult ResultCache::solve(const DensePreferences& preferences) const {
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    AssignmentResult result = Assignment(preferences, m_Splits, m_Forbidden, m_Options).solveCompact();
+    result.ids = &preferences.ids;
+    return result;
+  }
+  // the same split points as Assignment, everything else is one layer
+  std::vector<uint> splits;
+  for(uint split : m_Splits){
+    if(split > 0 && split < preferences.group_count){
+      splits.push_back(split);
+    }
+  }
+  std::sort(splits.begin(), splits.end());
+  splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+
+  Hasher key;
+  key.add(preferences.group_count);
+  key.add(splits.size());
+  for(uint split : splits){
+    key.add(split);
+  }
+  key.add(m_Forbidden.size());
+  for(const std::pair<uint,uint>& combination : m_Forbidden){
+    key.add(combination.first);
+    key.add(combination.second);
+  }
+  for(unsigned long long option : { (unsigned long long) m_Options.solver, (unsigned long long) m_Options.joint,
+                                    (unsigned long long) m_Options.joint_iterations, (unsigned long long) m_Options.refine_ms,
+                                    (unsigned long long) m_Options.starts, (unsigned long long) m_Options.seed,
+                                    (unsigned long long) m_Options.time_limit_ms }){
+    key.add(option);
+  }
+  Hash hash = preferencesHash(preferences);
+  char name[64];
+  char index_name[32];
+  std::snprintf(name, sizeof(name), "%016llx-%016llx.cache", key.hash(), hash);
+  std::snprintf(index_name, sizeof(index_name), "%016llx.index", key.hash());
+  mkdir(m_Directory.c_str(), 0777);
+  std::string path = m_Directory + "/" + name;
+  std::string index = m_Directory + "/" + index_name;
+
+  Entry entry;
+  AssignmentResult result;
+  if(readEntry(path, entry) && entry.hash == hash && samePreferences(entry.preferences, preferences)){
+    add_counter("cache.hits", 1);
+    result.ids = &preferences.ids;
+    result.layers = entry.layers;
+    result.groups = std::move(entry.groups);
+    result.costs = std::move(entry.costs);
+    certify_result(preferences, splits, result, m_Options);
+    useEntry(m_Directory, index, name);
+    return result;
+  }
+  // the entry of the preferences solved last with these options is the start of a repair
+  std::vector<std::string> entries = readIndex(index);
+  bool found = splits.empty() && !entries.empty() && entries.front() != name
+            && readEntry(m_Directory + "/" + entries.front(), entry);
+  std::vector<long long> prices;
+  if(found && repair(entry, preferences, result, prices)){
+    certify_result(preferences, splits, result, m_Options);
+  } else {
+    add_counter("cache.misses", 1);
+    result = Assignment(preferences, splits, m_Forbidden, m_Options).solveCompact();
+    result.ids = &preferences.ids;
+    uint group_size = group_capacity(preferences.size(), preferences.group_count);
+    if(splits.empty() && std::find(result.groups.begin(), result.groups.end(), -1) == result.groups.end()){
+      Certificate certificate = certify_assignment(preferences, result.groups, group_size);
+      if(certificate.optimal){
+        prices = certificate.prices;
+      }
+    }
+  }
+  writeEntry(path, hash, preferences, result, prices);
+  useEntry(m_Directory, index, name);
+  return result;
+}
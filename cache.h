@@ -0,0 +1,63 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Directory of solved assignments for runs that see mostly the same preferences again. An entry is
+ * named by a hash of the number of groups, the split points, the exclusive combinations and the
+ * solver options and the hash of the preferences. It keeps the preferences, the result and for a
+ * proven optimal single layer assignment the prices of the groups (see certificate.h). Equal
+ * preferences return the stored result. An index file per options lists its entries most recently
+ * used first and only the first few are kept. When at most a quarter of the participants of the
+ * first one were added, removed or changed, a single layer result is repaired from it with
+ * IncrementalAssignment, which is optimal but may break ties differently than a full solve.
+ * Everything else is solved and stored. Stored and repaired results are certified like solved ones
+ * for --verify and the statistics.
+ */
+class ResultCache {
+public:
+  ResultCache(const std::string& directory, const std::vector<uint>& splits,
+              const std::vector<std::pair<uint,uint>>& forbidden, const SolverOptions& options);
+
+  // ids of the result point to the preferences
+  AssignmentResult solve(const DensePreferences& preferences) const;
+
+private:
+  std::string m_Directory;
+  std::vector<uint> m_Splits;
+  std::vector<std::pair<uint,uint>> m_Forbidden;
+  SolverOptions m_Options;
+};
+
+} // namespace assign
@@ -0,0 +1,138 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <limits>
+#include <algorithm>
+#include "certificate.h"
+
+using namespace assign;
+
+namespace {
+
+const static long long UNREACHABLE = std::numeric_limits<long long>::max() / 4;
+
+// the dual value of the prices, valid for every assignment
+long long lowerBound(const DensePreferences& preferences, const std::vector<long long>& prices, uint group_size){
+  long long result = 0;
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    const Participant::Cost* row = preferences.row(participant);
+    long long best = UNREACHABLE;
+    for(uint group = 0; group < preferences.group_count; ++group){
+      best = std::min(best, row[group] + prices[group]);
+    }
+    result += best;
+  }
+  for(long long price : prices){
+    result -= group_size * price;
+  }
+  return result;
+}
+
+// moves[from * groups + to]: cheapest change of costs when a participant of from goes to to
+std::vector<long long> moveCosts(const DensePreferences& preferences, const std::vector<GroupId>& groups){
+  uint group_count = preferences.group_count;
+  std::vector<long long> result((std::size_t) group_count * group_count, UNREACHABLE);
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    const Participant::Cost* row = preferences.row(participant);
+    GroupId from = groups[participant];
+    long long* moves = result.data() + (std::size_t) from * group_count;
+    for(uint to = 0; to < group_count; ++to){
+      moves[to] = std::min<long long>(moves[to], row[to] - row[from]);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+Certificate assign::certify_assignment(const DensePreferences& preferences, const std::vector<GroupId>& groups,
+                                       uint group_size)
+{
+  Certificate result;
+  uint group_count = preferences.group_count;
+  result.prices.assign(group_count, 0);
+  std::vector<uint> counts(group_count, 0);
+  result.complete = groups.size() == preferences.size();
+  for(uint participant = 0; result.complete && participant < preferences.size(); ++participant){
+    GroupId group = groups[participant];
+    result.complete = group >= 0 && group < (GroupId) group_count && ++counts[group] <= group_size;
+    if(result.complete){
+      result.cost += preferences.row(participant)[group];
+    }
+  }
+  result.lower_bound = lowerBound(preferences, result.prices, group_size);
+  if(!result.complete){
+    return result;
+  }
+
+  // p[from] <= p[to] + move(from, to) for every move, p == 0 for groups with free places. the shortest
+  // paths to the free places solve this unless moves along a cycle or into a free place save costs.
+  // without free places every group starts at 0 as if there was a free place behind each of them
+  std::vector<long long> moves = moveCosts(preferences, groups);
+  std::vector<long long>& prices = result.prices;
+  bool full = std::find_if(counts.begin(), counts.end(), [group_size](uint count){
+    return count < group_size;
+  }) == counts.end();
+  for(uint group = 0; group < group_count; ++group){
+    prices[group] = full || counts[group] < group_size ? 0 : UNREACHABLE;
+  }
+  bool changed = true;
+  for(uint round = 0; changed && round <= group_count; ++round){
+    changed = false;
+    for(uint from = 0; from < group_count; ++from){
+      const long long* row = moves.data() + (std::size_t) from * group_count;
+      for(uint to = 0; to < group_count; ++to){
+        if(row[to] != UNREACHABLE && prices[to] != UNREACHABLE && prices[to] + row[to] < prices[from]){
+          prices[from] = prices[to] + row[to];
+          changed = true;
+        }
+      }
+    }
+  }
+  if(full){ // without free places every group may be shifted by the same price
+    long long lowest = *std::min_element(prices.begin(), prices.end());
+    for(long long& price : prices){
+      price -= lowest;
+    }
+  }
+  bool feasible = !changed && std::find_if(prices.begin(), prices.end(), [](long long price){
+    return price < 0 || price == UNREACHABLE;
+  }) == prices.end();
+  if(!feasible){
+    for(long long& price : prices){
+      price = price == UNREACHABLE ? 0 : std::max(price, 0LL);
+    }
+  }
+  long long bound = lowerBound(preferences, prices, group_size);
+  if(bound < result.lower_bound){
+    std::fill(prices.begin(), prices.end(), 0);
+  } else {
+    result.lower_bound = bound;
+  }
+  result.optimal = result.lower_bound == result.cost;
+  return result;
+}
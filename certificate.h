@@ -0,0 +1,55 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Dual proof for a single layer assignment where every group takes up to group_size participants.
+ * With group prices p >= 0 no assignment is cheaper than
+ *   sum over participants of min over groups (cost + p) - group_size * sum of p.
+ * The prices are the shortest paths to the groups with free places over the costs of moving one
+ * participant, which reach the costs exactly when the assignment is optimal. Otherwise the better of
+ * these prices and zero prices gives the bound.
+ */
+struct Certificate {
+  bool complete = false; // every participant has a group
+  bool optimal = false;  // lower_bound == cost
+  long long cost = 0;
+  long long lower_bound = 0;
+  std::vector<long long> prices; // of every group
+};
+
+// O(participants * groups) plus the shortest paths between the groups
+Certificate certify_assignment(const DensePreferences& preferences, const std::vector<GroupId>& groups,
+                               uint group_size);
+
+} // namespace assign
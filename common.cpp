@@ -25,10 +25,56 @@
 * DEALINGS IN THE SOFTWARE.                                          *
 *********************************************************************/
 
+#include <mutex>
+#include <atomic>
 #include "common.h"
+#include "flow.h"
+#include "solver.h"
+#include "certificate.h"
+#include "components.h"
+#include "joint.h"
+#include "refine.h"
+#include "multistart.h"
+#include "thread_pool.h"
+#include "stats.h"
 
 using namespace assign;
 
+namespace {
+
+thread_local std::ostream* warnings = nullptr;
+std::atomic<std::ostream*> default_warnings(nullptr);
+std::mutex warnings_mutex;
+
+}
+
+std::ostream& assign::warning_stream(){
+  if(warnings){
+    return *warnings;
+  }
+  std::ostream* stream = default_warnings;
+  return stream ? *stream : std::cerr;
+}
+
+void assign::set_warning_stream(std::ostream* stream){
+  warnings = stream;
+}
+
+void assign::set_default_warning_stream(std::ostream* stream){
+  default_warnings = stream;
+}
+
+void assign::write_warning(const std::string& text){
+  std::lock_guard<std::mutex> lock(warnings_mutex);
+  warning_stream() << text << std::flush;
+}
+
+uint assign::group_capacity(uint participants, uint group_count){
+  uint group_size = participants / group_count;
+  if(participants % group_count) { ++group_size; } // rounding up
+  return group_size;
+}
+
 std::vector<std::string> assign::split(const std::string& data, char delimiter) {
   std::vector<std::string> result;
   std::stringstream stream(data);
@@ -39,38 +85,107 @@ std::vector<std::string> assign::split(const std::string& data, char delimiter)
   return result;
 }
 
+Solver assign::parse_solver(const std::string& name){
+  if(name.empty() || name == "munkres"){
+    return Solver::MUNKRES;
+  } else if(name == "flow"){
+    return Solver::FLOW;
+  } else if(name == "lapjv"){
+    return Solver::LAPJV;
+  } else if(name == "auction"){
+    return Solver::AUCTION;
+  } else if(name == "approx"){
+    return Solver::APPROX;
+  } else {
+    ERROR(1,"Unknown solver '" << name << "'. Use one of: munkres, flow, lapjv, auction, approx.");
+  }
+}
+
+SolverOptions assign::parse_solver_options(const ProgArgs& args){
+  SolverOptions result;
+  auto solver = args.find("solver");
+  if(solver != args.end()){
+    result.solver = parse_solver(solver->second);
+  }
+  auto threads = args.find("threads");
+  if(threads != args.end()){
+    result.threads = parse<uint>(threads->second);
+  }
+  result.joint = args.count("joint") > 0 && !args.at("joint").empty();
+  auto iterations = args.find("iterations");
+  if(iterations != args.end()){
+    result.joint_iterations = parse<uint>(iterations->second);
+  }
+  auto refine = args.find("refine-ms");
+  if(refine != args.end()){
+    result.refine_ms = parse<uint>(refine->second);
+  }
+  auto starts = args.find("starts");
+  if(starts != args.end()){
+    result.starts = parse<uint>(starts->second);
+  }
+  auto seed = args.find("seed");
+  if(seed != args.end()){
+    result.seed = parse<unsigned long>(seed->second);
+  }
+  auto time_limit = args.find("time-limit");
+  if(time_limit != args.end()){
+    result.time_limit_ms = parse<uint>(time_limit->second);
+  }
+  result.verify = args.count("verify") > 0 && !args.at("verify").empty();
+  return result;
+}
+
 namespace {
 
 const static uint HIGH_VALUE = 10000;
 
-std::vector<Assignment::ParticipantAssignment> create_assignments(
-    const std::vector<Participant>& participants, const uint group_count, const Matrix<double>& solution,
-    const Matrix<double>& cost_matrix)
+typedef std::vector<std::vector<GroupId>> LayerGroups; // groups of every participant per layer
+
+// flat result of all layers. the costs come from the preferences of each layer
+AssignmentResult createResult(const std::vector<Participant::Id>& ids,
+                              const std::vector<const DensePreferences*>& layers, const LayerGroups& groups)
 {
-  std::vector<Assignment::ParticipantAssignment> result;
-  result.reserve(participants.size());
-  for(uint i = 0; i < participants.size(); ++i){
-    uint column = i;
-    std::vector<int> groups;
-    for (uint row = 0; row < solution.rows(); ++row){
-      if(solution(row,column) == 0){
-//        groups.push_back(row % group_count);
-        groups.push_back(row);
+  assert(layers.size() == groups.size());
+  AssignmentResult result;
+  result.ids = &ids;
+  result.layers = layers.size();
+  result.groups.resize(ids.size() * layers.size());
+  result.costs.resize(ids.size() * layers.size());
+  for(uint layer = 0; layer < layers.size(); ++layer){
+    const DensePreferences& preferences = *layers[layer];
+    for(uint i = 0; i < ids.size(); ++i){
+      GroupId group = groups[layer][i];
+      std::size_t index = (std::size_t) i * layers.size() + layer;
+      if(group < 0){
+        WARNING("Participant " << ids[i] << " could not be assigned to a group");
+        result.groups[index] = -1;
+        result.costs[index] = -1;
+      } else {
+        result.groups[index] = group;
+        result.costs[index] = preferences.row(i)[group];
       }
     }
-      result.push_back(Assignment::ParticipantAssignment());
-      result.back().participant = participants[i].id;
-    if(groups.size() == 0){
-      WARNING("Participant " << participants[i].id << " could not be assigned to a group");
-      result.back().assigned_groups.push_back(-1);
-      result.back().costs.push_back(-1);
+  }
+  return result;
+}
+
+AssignmentResult createResult(const SparsePreferences& preferences, const std::vector<GroupId>& groups){
+  AssignmentResult result;
+  result.ids = &preferences.ids;
+  result.layers = 1;
+  result.groups.resize(preferences.size());
+  result.costs.resize(preferences.size());
+  for(uint i = 0; i < preferences.size(); ++i){
+    if(groups[i] < 0){
+      WARNING("Participant " << preferences.ids[i] << " could not be assigned to any of its groups");
+      result.groups[i] = -1;
+      result.costs[i] = -1;
     } else {
-      if(groups.size() > 1){
-        WARNING("Participant " << participants[i].id << " was assigned to multiple groups: " << to_string(groups)
-                << " will use the first.");
-      }
-      result.back().assigned_groups.push_back(groups.front() % group_count);
-      result.back().costs.push_back(cost_matrix(groups.front(),i));
+      uint edge = preferences.offsets[i];
+      while(preferences.groups[edge] != groups[i]) { ++edge; }
+      result.groups[i] = groups[i];
+      result.costs[i] = preferences.costs[edge];
     }
   }
   return result;
@@ -86,121 +201,239 @@ std::vector<std::pair<T,U>> swap(std::vector<std::pair<U,T>> vector){
   return result;
 }
 
-Matrix<double> create_matrix(const std::vector<Participant>& participants, uint group_count){
-  uint group_size = participants.size() / group_count;
-  if(participants.size() % group_count) { ++group_size; } // rounding up
-  uint columns = participants.size(); // true count of entities
-  uint rows = group_count * group_size;
-
-  Matrix<double> result(rows,columns);
+std::vector<GroupId> simpleGroups(const DensePreferences& preferences, const SolverOptions& options){
+  if(stats_enabled()){
+    set_statistic("matrix.participants", preferences.size());
+    set_statistic("matrix.groups", preferences.group_count);
+  }
+  return solve_narrowest(preferences, options);
+}
 
-  for(uint row = 0; row < rows; ++row){
-    for(uint column = 0; column < columns; ++column){
-      uint looped_row = row % group_count;
-      result(row, column) = participants[column].preferences[looped_row]; // transposing
+long long totalCost(const std::vector<const DensePreferences*>& layers, const LayerGroups& groups){
+  long long result = 0;
+  for(uint layer = 0; layer < layers.size(); ++layer){
+    for(uint i = 0; i < layers[layer]->size(); ++i){
+      GroupId group = groups[layer][i];
+      result += group < 0 ? -1 : layers[layer]->row(i)[group];
     }
   }
   return result;
 }
 
-std::vector<Assignment::ParticipantAssignment> mergeAssignments(
-    const std::vector<Assignment::ParticipantAssignment>& first,
-    const std::vector<Assignment::ParticipantAssignment>& second)
+struct HeuristicOption {
+  LayerGroups groups;
+  long long cost = 0; // including the penalties
+};
+
+// solves first and then second with penalties on the forbidden combinations of the first result
+HeuristicOption assignHeuristicWithWeights(
+    const DensePreferences& first,
+    DensePreferences second,
+    const std::vector<std::pair<uint,uint>>& forbidden,
+    const SolverOptions& options)
 {
-  assert(first.size() == second.size());
-  auto result = first;
-  for (uint i = 0; i < first.size(); ++i){
-    assert(first.at(i).participant == second.at(i).participant);
-    result.at(i).assigned_groups.insert(
-          result.at(i).assigned_groups.end(),
-          second.at(i).assigned_groups.begin(),
-          second.at(i).assigned_groups.end());
-    result.at(i).costs.insert(
-          result.at(i).costs.end(),
-          second.at(i).costs.begin(),
-          second.at(i).costs.end());
-  }
-  return result;
+   StatsPhase phase("heuristic.option");
+   HeuristicOption result;
+   result.groups.push_back(simpleGroups(first, options));
+   for(uint i = 0; i < first.size(); ++i){
+     for(auto f : forbidden){
+       if(result.groups.front()[i] == (GroupId) f.first){
+         second.row(i)[f.second] += HIGH_VALUE;
+       }
+     }
+   }
+   result.groups.push_back(simpleGroups(second, options));
+   result.cost = totalCost({ &first, &second }, result.groups);
+   return result;
 }
 
-const std::vector<Assignment::ParticipantAssignment>& findBestAssignment(
-    const std::vector<std::vector<Assignment::ParticipantAssignment>>& options)
-{
+const LayerGroups& findBestAssignment(const std::vector<HeuristicOption>& options){
   uint best = 0;
-  uint bestCost = std::numeric_limits<Participant::Cost>::max();
-  std::vector<Participant::Cost> costs;
+  std::vector<long long> costs;
   for(uint i = 0; i < options.size(); ++i){
-    costs.push_back(0);
-    for (auto assignment : options.at(i)){
-      for (Participant::Cost cost : assignment.costs){
-        costs.back() += cost;
-      }
-    }
-    if(costs.back() < bestCost){
+    costs.push_back(options[i].cost);
+    append_statistic("heuristic.option_costs", options[i].cost);
+    if(costs.back() < costs[best]){
       best = i;
-      bestCost = costs.back();
     }
   }
   WARNING("Heuristic found assignments with costs: " << to_string(costs));
-  return options.at(best);
+  return options.at(best).groups;
 }
 
-std::vector<Assignment::ParticipantAssignment> simpleAssignment(const std::vector<Participant>& participants){
-  uint group_count = participants.front().preferences.size();
-  Matrix<double> cost_matrix = std::move(create_matrix(participants, group_count));
-  Matrix<double> solution = cost_matrix;
-  Munkres munkres;
-  munkres.solve(solution);
-  return create_assignments(participants,group_count,solution,cost_matrix);
+void refineAssignment(
+    const DensePreferences& first,
+    const DensePreferences& second,
+    const std::vector<std::pair<uint,uint>>& forbidden,
+    LayerGroups& groups,
+    const SolverOptions& solver_options)
+{
+  for(uint i = 0; i < first.size(); ++i){
+    if(groups[0][i] < 0 || groups[1][i] < 0 || groups[0][i] >= (GroupId) first.group_count
+       || groups[1][i] >= (GroupId) second.group_count){
+      return;
+    }
+  }
+  StatsPhase phase("refine");
+  Refinement refinement = refine_assignment(first, second, forbidden, groups[0], groups[1],
+                                            solver_options.refine_ms, solver_options.threads);
+  add_counter("refine.rounds", refinement.rounds);
+  WARNING("Refinement reduced the costs from " << refinement.cost_before << " to " << refinement.cost_after
+          << " and the forbidden combinations from " << refinement.violations_before << " to "
+          << refinement.violations_after << " in " << refinement.rounds << " rounds.");
 }
 
-std::vector<Assignment::ParticipantAssignment> assignHeuristicWithWeights(
-    const std::vector<Participant>& first,
-    std::vector<Participant> second,
-    const std::vector<std::pair<uint,uint>>& forbidden)
+LayerGroups multistartAssignment(
+    const DensePreferences& first,
+    const DensePreferences& second,
+    const std::vector<std::pair<uint,uint>>& forbidden,
+    const SolverOptions& solver_options)
 {
-   auto assignment = simpleAssignment(first);
-   for(uint i = 0; i < assignment.size(); ++i){
-     for(auto f : forbidden){
-       if(assignment.at(i).assigned_groups.back() == f.first){
-         second.at(i).preferences.at(f.second) += HIGH_VALUE;
-       }
-     }
-   }
-   return mergeAssignments(assignment,simpleAssignment(second));
+  StatsPhase phase("multistart");
+  SolverOptions layer_options = solver_options;
+  layer_options.threads = 1; // the starts run in parallel instead
+  MultiStart multistart = multistart_assignment(first, second, forbidden, [&](const DensePreferences& layer){
+    return simpleGroups(layer, layer_options);
+  }, solver_options.starts, solver_options.seed, solver_options.threads);
+  for(long long cost : multistart.costs){
+    append_statistic("heuristic.option_costs", cost);
+  }
+  WARNING("Heuristic found assignments with costs: " << to_string(multistart.costs) << " the best is start "
+          << multistart.best_start << " with " << multistart.violations << " forbidden combinations.");
+  return LayerGroups{ std::move(multistart.first), std::move(multistart.second) };
+}
+
+LayerGroups heuristicAssignment(
+    const DensePreferences& first,
+    const DensePreferences& second,
+    std::vector<std::pair<uint,uint>> forbidden,
+    const SolverOptions& solver_options)
+{
+  LayerGroups result;
+  if(solver_options.starts > 0){
+    result = multistartAssignment(first, second, forbidden, solver_options);
+  } else {
+    std::vector<HeuristicOption> options;
+    options.push_back(assignHeuristicWithWeights(first,second,forbidden,solver_options));
+    options.push_back(assignHeuristicWithWeights(second,first,swap(forbidden),solver_options));
+    std::swap(options.back().groups[0], options.back().groups[1]); // back to first, second
+    result = findBestAssignment(options);
+  }
+  if(solver_options.refine_ms > 0){
+    refineAssignment(first, second, forbidden, result, solver_options);
+  }
+  return result;
 }
 
-std::vector<Assignment::ParticipantAssignment> heuristicAssignment(
-    std::vector<Participant> first,
-    std::vector<Participant> second,
-    std::vector<std::pair<uint,uint>> forbidden)
+LayerGroups jointAssignment(
+    const DensePreferences& first,
+    const DensePreferences& second,
+    const std::vector<std::pair<uint,uint>>& forbidden,
+    const SolverOptions& solver_options)
 {
-  std::vector<std::vector<Assignment::ParticipantAssignment>> options;
-  options.push_back(assignHeuristicWithWeights(first,second,forbidden));
-  options.push_back(assignHeuristicWithWeights(second,first,swap(forbidden)));
-  return findBestAssignment(options);
+  StatsPhase phase("joint");
+  JointAssignment joint = joint_assignment(first, second, forbidden, solver_options.joint_iterations,
+                                           solver_options.deadline);
+  add_counter("joint.iterations", joint.iterations);
+  if(!joint.relaxed){
+    WARNING("Costs are too large for the joint solver, using the heuristic instead.");
+    return heuristicAssignment(first, second, forbidden, solver_options);
+  }
+  if(joint.violations > 0){
+    WARNING("Joint solver could not avoid " << joint.violations << " forbidden combinations.");
+  }
+  if(joint.lower_bound == std::numeric_limits<long long>::min()){
+    WARNING("Joint solver found assignment with costs " << joint.cost << " without a lower bound after "
+            << joint.iterations << " iterations.");
+  } else {
+    WARNING("Joint solver found assignment with costs " << joint.cost << ", lower bound " << joint.lower_bound
+            << " (gap " << joint.cost - joint.lower_bound << ") after " << joint.iterations << " iterations.");
+  }
+  return LayerGroups{ std::move(joint.first), std::move(joint.second) };
 }
 
-void splitParticipants(const std::vector<Participant>& src, uint split_before,
-                       std::vector<Participant>& dst1, std::vector<Participant>& dst2)
+// sum of the certificates of all layers. forbidden combinations only make the optimum more expensive,
+// so the bound holds for them as well but is not reached when they had to be avoided
+void certifyAssignment(const std::vector<const DensePreferences*>& layers, const LayerGroups& groups,
+                       const SolverOptions& options)
 {
-  assert(split_before > 0);
-  dst1.clear(); dst2.clear();
-  dst1.resize(src.size()); dst2.resize(src.size());
-  for(uint i = 0; i < src.size(); ++i){
-    assert(split_before < src.at(i).preferences.size());
-    dst1.at(i).id = src.at(i).id;
-    dst2.at(i).id = src.at(i).id;
-    dst1.at(i).preferences.reserve(split_before);
-    dst2.at(i).preferences.reserve(src.at(i).preferences.size()-split_before);
-    for(uint j = 0; j < src.at(i).preferences.size(); ++j){
-      if(j  < split_before){
-        dst1.at(i).preferences.push_back(src.at(i).preferences.at(j));
-      } else {
-        dst2.at(i).preferences.push_back(src.at(i).preferences.at(j));
-      }
+  if(!options.verify && !stats_enabled()){
+    return;
+  }
+  StatsPhase phase("certificate");
+  long long cost = 0, lower_bound = 0;
+  bool complete = true;
+  for(uint layer = 0; layer < layers.size(); ++layer){
+    const DensePreferences& preferences = *layers[layer];
+    if(preferences.size() == 0 || preferences.group_count == 0){
+      continue;
+    }
+    Certificate certificate = certify_assignment(preferences, groups[layer],
+                                                 group_capacity(preferences.size(), preferences.group_count));
+    complete = complete && certificate.complete;
+    cost += certificate.cost;
+    lower_bound += certificate.lower_bound;
+  }
+  set_statistic("certificate.cost", cost);
+  set_statistic("certificate.lower_bound", lower_bound);
+  set_statistic("certificate.gap", cost - lower_bound);
+  set_statistic("certificate.optimal", complete && cost == lower_bound);
+  if(!options.verify){
+    return;
+  }
+  if(!complete){
+    WARNING("Could not verify the assignment, not every participant has a group. Lower bound " << lower_bound << ".");
+  } else if(cost == lower_bound){
+    WARNING("Verified assignment with costs " << cost << " as optimal.");
+  } else {
+    WARNING("Verified assignment with costs " << cost << ", lower bound " << lower_bound
+            << " (gap " << cost - lower_bound << ").");
+  }
+}
+
+// one layer of preferences per range between the split points
+std::vector<DensePreferences> splitParticipants(const DensePreferences& src, const std::vector<uint>& splits){
+  std::vector<uint> bounds(1, 0);
+  bounds.insert(bounds.end(), splits.begin(), splits.end());
+  bounds.push_back(src.group_count);
+  std::vector<DensePreferences> result(bounds.size() - 1);
+  for(uint layer = 0; layer < result.size(); ++layer){
+    DensePreferences& dst = result[layer];
+    assert(bounds[layer] < bounds[layer + 1]);
+    dst.ids = src.ids;
+    dst.group_count = bounds[layer + 1] - bounds[layer];
+    dst.costs.resize((std::size_t) src.size() * dst.group_count);
+    for(uint i = 0; i < src.size(); ++i){
+      std::copy(src.row(i) + bounds[layer], src.row(i) + bounds[layer + 1], dst.row(i));
     }
   }
+  return result;
+}
+
+// independent layers are solved at the same time
+LayerGroups layeredAssignment(const std::vector<DensePreferences>& layers, const SolverOptions& options){
+  LayerGroups results(layers.size());
+  ThreadPool pool(std::min<uint>(layers.size(), options.threads == 0 ? std::thread::hardware_concurrency()
+                                                                     : options.threads));
+  pool.parallel_for(layers.size(), [&](uint begin, uint end){
+    for(uint layer = begin; layer < end; ++layer){
+      results[layer] = simpleGroups(layers[layer], options);
+    }
+  });
+  return results;
+}
+
+std::vector<Assignment::ParticipantAssignment> toParticipantAssignments(const AssignmentResult& result){
+  std::vector<Assignment::ParticipantAssignment> assignments(result.size());
+  for(uint i = 0; i < result.size(); ++i){
+    Assignment::ParticipantAssignment& assignment = assignments[i];
+    assignment.participant = result.id(i);
+    assignment.assigned_groups.assign(result.groups.begin() + (std::size_t) i * result.layers,
+                                      result.groups.begin() + (std::size_t) (i + 1) * result.layers);
+    assignment.costs.assign(result.costs.begin() + (std::size_t) i * result.layers,
+                            result.costs.begin() + (std::size_t) (i + 1) * result.layers);
+  }
+  return assignments;
 }
 
 } // namespace
@@ -219,10 +452,8 @@ std::vector<Participant> Participant::fromCsv(std::istream &csv_stream){
   std::vector<Participant> result;
   uint preferences_count = 0;
   uint line = 1;
-  while(std::cin) {
-    std::string participant_csv;
-    std::getline(csv_stream, participant_csv);
-    if(std::cin.eof()) break;
+  std::string participant_csv;
+  while(std::getline(csv_stream, participant_csv)) {
     result.push_back(Participant::fromCsvLine(participant_csv));
     if(line == 1){
       preferences_count = result.front().preferences.size();
@@ -237,40 +468,140 @@ std::vector<Participant> Participant::fromCsv(std::istream &csv_stream){
   return result;
 }
 
+void DensePreferences::materialize(){
+  if(mapped != nullptr){
+    costs.assign(mapped, mapped + cost_count());
+    mapped = nullptr;
+    mapping.reset();
+  }
+}
+
+DensePreferences DensePreferences::fromParticipants(const std::vector<Participant>& participants){
+  DensePreferences result;
+  result.group_count = participants.empty() ? 0 : participants.front().preferences.size();
+  result.ids.reserve(participants.size());
+  result.costs.reserve((std::size_t) participants.size() * result.group_count);
+  for(const Participant& participant : participants){
+    assert(participant.preferences.size() == result.group_count);
+    result.ids.push_back(participant.id);
+    result.costs.insert(result.costs.end(), participant.preferences.begin(), participant.preferences.end());
+  }
+  return result;
+}
+
 Assignment::Assignment(std::vector<Participant> participants, uint assignment_split,
-                       std::vector<std::pair<uint,uint>> forbidden_combinations)
-  : m_Participants(participants), m_AssignmentSplit(assignment_split), m_ForbiddenCombinations(forbidden_combinations)
+                       std::vector<std::pair<uint,uint>> forbidden_combinations, SolverOptions options)
+  : Assignment(DensePreferences::fromParticipants(participants), assignment_split, forbidden_combinations, options)
 {}
 
-std::vector<Assignment::ParticipantAssignment> Assignment::solve() const {
-  if(m_Participants.empty() || m_Participants.front().preferences.empty()){
-    return std::vector<Assignment::ParticipantAssignment>();
+Assignment::Assignment(DensePreferences preferences, uint assignment_split,
+                       std::vector<std::pair<uint,uint>> forbidden_combinations, SolverOptions options)
+  : Assignment(std::move(preferences), std::vector<uint>(assignment_split ? 1 : 0, assignment_split),
+               forbidden_combinations, options)
+{}
+
+Assignment::Assignment(DensePreferences preferences, std::vector<uint> assignment_splits,
+                       std::vector<std::pair<uint,uint>> forbidden_combinations, SolverOptions options)
+  : m_Preferences(std::move(preferences)), m_AssignmentSplits(std::move(assignment_splits)),
+    m_ForbiddenCombinations(forbidden_combinations), m_Options(options)
+{}
+
+Assignment::Assignment(SparsePreferences preferences, SolverOptions options)
+  : m_Options(options), m_SparsePreferences(std::move(preferences))
+{}
+
+AssignmentResult Assignment::solveCompact() const {
+  if(m_SparsePreferences.size() > 0){
+    if(m_SparsePreferences.group_count == 0){ // nobody listed a group
+      return createResult(m_SparsePreferences, std::vector<GroupId>(m_SparsePreferences.size(), -1));
+    }
+    uint group_size = group_capacity(m_SparsePreferences.size(), m_SparsePreferences.group_count);
+    StatsPhase phase("flow");
+    return createResult(m_SparsePreferences, component_assignment(m_SparsePreferences, group_size, m_Options.threads));
+  }
+  if(m_Preferences.size() == 0 || m_Preferences.group_count == 0){
+    return AssignmentResult();
+  }
+
+  std::vector<uint> splits;
+  for(uint split : m_AssignmentSplits){
+    if(split > 0 && split < m_Preferences.group_count){
+      splits.push_back(split);
+    }
   }
+  std::sort(splits.begin(), splits.end());
+  splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
 
-  if(m_AssignmentSplit < 1 || m_AssignmentSplit >= m_Participants.front().preferences.size()){ // simple assgnment
-    return simpleAssignment(m_Participants);
+  SolverOptions options = m_Options;
+  if(options.time_limit_ms > 0){
+    options.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.time_limit_ms);
+  }
+  if(splits.empty()){ // simple assgnment
+    LayerGroups groups{ simpleGroups(m_Preferences, options) };
+    certifyAssignment({ &m_Preferences }, groups, options);
+    return createResult(m_Preferences.ids, { &m_Preferences }, groups);
+  }
+  options.progress = nullptr; // only single layers report their progress
+  std::vector<DensePreferences> layers = splitParticipants(m_Preferences, splits);
+  std::vector<const DensePreferences*> layer_pointers;
+  for(const DensePreferences& layer : layers){
+    layer_pointers.push_back(&layer);
+  }
+  LayerGroups groups;
+  if(m_ForbiddenCombinations.empty()){
+    groups = layeredAssignment(layers, options);
+  } else if(layers.size() != 2){
+    ERROR(1, "Exclusive combinations need exactly one split point.");
+  } else if(options.joint){
+    groups = jointAssignment(layers[0],layers[1],m_ForbiddenCombinations,options);
   } else {
-    std::vector<Participant> first,second;
-    splitParticipants(m_Participants,m_AssignmentSplit,first,second);
-    if(m_ForbiddenCombinations.empty()){
-      return mergeAssignments(simpleAssignment(first), simpleAssignment(second));
-    } else {
-      return heuristicAssignment(first,second,m_ForbiddenCombinations);
+    groups = heuristicAssignment(layers[0],layers[1],m_ForbiddenCombinations,options);
+  }
+  certifyAssignment(layer_pointers, groups, options);
+  return createResult(m_Preferences.ids, layer_pointers, groups);
+}
+
+std::vector<Assignment::ParticipantAssignment> Assignment::solve() const {
+  return toParticipantAssignments(solveCompact());
+}
+
+void assign::certify_result(const DensePreferences& preferences, const std::vector<uint>& splits,
+                            const AssignmentResult& result, const SolverOptions& options)
+{
+  if(!options.verify && !stats_enabled()){
+    return;
+  }
+  std::vector<DensePreferences> layers = splitParticipants(preferences, splits);
+  std::vector<const DensePreferences*> layer_pointers;
+  LayerGroups groups(layers.size(), std::vector<GroupId>(preferences.size()));
+  for(uint layer = 0; layer < layers.size(); ++layer){
+    layer_pointers.push_back(&layers[layer]);
+    for(uint i = 0; i < preferences.size(); ++i){
+      groups[layer][i] = result.groups[(std::size_t) i * layers.size() + layer];
     }
   }
+  certifyAssignment(layer_pointers, groups, options);
+}
+
+std::vector<GroupId> assign::solve_groups(const DensePreferences& preferences, const SolverOptions& options){
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    return std::vector<GroupId>(preferences.size(), -1);
+  }
+  return simpleGroups(preferences, options);
 }
 
-void assign::print_assignments_csv(const std::vector<Assignment::ParticipantAssignment>& assignments, bool print_costs){
-  for (auto participant : assignments){
-    std::cout << participant.participant;
-    for(auto group : participant.assigned_groups){
-      std::cout << "," << group;
+void assign::print_assignments_csv(const std::vector<Assignment::ParticipantAssignment>& assignments, bool print_costs,
+                                   std::ostream& stream){
+  for (const Assignment::ParticipantAssignment& participant : assignments){
+    stream << participant.participant;
+    for(GroupId group : participant.assigned_groups){
+      stream << "," << group;
     }
     if(print_costs){
-      for(auto cost : participant.costs){
-        std::cout << "," << cost;
+      for(Participant::Cost cost : participant.costs){
+        stream << "," << cost;
       }
     }
-    std::cout << std::endl;
+    stream << '\n';
   }
 }
@@ -28,17 +28,22 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <sstream>
 #include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <iostream>
-#include "munkres.h"
-#include "matrix.h"
+#include <limits>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
 
-#define WARNING(TXT) { std::cout << "WARNING: " << TXT<< std::endl; }
-#define ERROR(ERRVAL,TXT) { std::cout << "ERROR: " << TXT << std::endl; exit(ERRVAL); }
+#define WARNING(TXT) { std::ostringstream warning_text; warning_text << "WARNING: " << TXT << "\n"; \
+                      assign::write_warning(warning_text.str()); }
+#define ERROR(ERRVAL,TXT) { std::ostringstream error_text; error_text << TXT; \
+                          throw assign::Error(ERRVAL, error_text.str()); }
 
 namespace assign {
 
@@ -46,6 +51,38 @@ typedef unsigned int uint;
 typedef int GroupId;
 typedef std::map<std::string,std::string> ProgArgs;
 
+// thrown by ERROR. the executables print the message and exit with the code
+class Error : public std::runtime_error {
+public:
+  Error(int code, const std::string& message) : std::runtime_error(message), m_Code(code) {}
+  int code() const { return m_Code; }
+private:
+  int m_Code;
+};
+
+enum class Solver {
+  MUNKRES, // hungarian method on a participants x participants matrix
+  FLOW,    // min-cost-flow with groups as capacitated nodes
+  LAPJV,   // shortest augmenting paths on an integer participants x participants matrix
+  AUCTION, // parallel auction with epsilon scaling
+  APPROX    // regret greedy and a few rounds of improving moves, reports the gap to a lower bound
+};
+
+struct SolverOptions {
+  Solver solver = Solver::MUNKRES;
+  uint threads = 0; // 0: all cores
+  bool joint = false; // solve exclusive combinations jointly instead of layer by layer
+  uint joint_iterations = 100;
+  uint refine_ms = 0; // local search after the exclusive heuristic, 0: off
+  uint starts = 0; // randomized starts of the exclusive heuristic, 0: only the two plain orders
+  unsigned long seed = 1;
+  uint time_limit_ms = 0; // 0: no limit. otherwise the auction returns its best assignment at the deadline
+  bool verify = false; // report the lower bound of certify_assignment (certificate.h) for the result
+  // called with every improved assignment of a single layer under a time limit
+  std::function<void(const std::vector<GroupId>& groups, long long cost, long long lower_bound)> progress;
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); // set by solve
+};
+
 struct Participant {
   typedef int Cost;
   typedef std::string Id;
@@ -57,6 +94,76 @@ struct Participant {
   static std::vector<Participant> fromCsv(std::istream& csv_stream);
 };
 
+/**
+ * Preferences of all participants in one contiguous row-major participants x groups block. The block
+ * is either owned in costs or mapped from a binary preferences file (see binary.h). Copies share the
+ * mapping, writing through row() copies the mapped block into costs first.
+ */
+struct DensePreferences {
+  std::vector<Participant::Id> ids;
+  std::vector<Participant::Cost> costs; // empty while the costs are mapped
+  uint group_count = 0;
+  std::shared_ptr<const void> mapping;   // keeps the mapped block alive
+  const Participant::Cost* mapped = nullptr;
+
+  uint size() const { return ids.size(); }
+  const Participant::Cost* data() const { return mapped != nullptr ? mapped : costs.data(); }
+  std::size_t cost_count() const { return (std::size_t) size() * group_count; }
+  Participant::Cost* row(uint participant) {
+    if(mapped != nullptr) { materialize(); }
+    return costs.data() + (std::size_t) participant * group_count;
+  }
+  const Participant::Cost* row(uint participant) const {
+    return data() + (std::size_t) participant * group_count;
+  }
+  // copies mapped costs into costs and releases the mapping
+  void materialize();
+
+  static DensePreferences fromParticipants(const std::vector<Participant>& participants);
+  static DensePreferences fromCsv(std::istream& csv_stream);
+  static DensePreferences fromCsvFile(const std::string& path);
+  static DensePreferences fromBinaryFile(const std::string& path);
+  // binary preferences files are recognized by their header, everything else is read as csv
+  static DensePreferences fromFile(const std::string& path);
+};
+
+/**
+ * Preferences where every participant only lists acceptable groups as 'id,group:cost,group:cost'.
+ * Stored as compressed sparse rows: the preferences of participant i are at [offsets[i],offsets[i+1]).
+ */
+struct SparsePreferences {
+  std::vector<Participant::Id> ids;
+  std::vector<uint> offsets = std::vector<uint>(1, 0);
+  std::vector<GroupId> groups;
+  std::vector<Participant::Cost> costs;
+  uint group_count = 0;
+
+  uint size() const { return ids.size(); }
+
+  // group_count can be used to add groups which are not listed by anyone
+  static SparsePreferences fromCsv(std::istream& csv_stream, uint group_count = 0);
+  static SparsePreferences fromCsvFile(const std::string& path, uint group_count = 0);
+};
+
+/**
+ * Result of a solve as flat arrays with one entry per participant and layer, participant major.
+ * Groups and costs are -1 for participants which could not be assigned. ids points to the ids of the
+ * solved preferences and is valid as long as the Assignment which created the result.
+ */
+struct AssignmentResult {
+  const std::vector<Participant::Id>* ids = nullptr;
+  uint layers = 0;
+  std::vector<GroupId> groups;
+  std::vector<Participant::Cost> costs;
+
+  uint size() const { return layers == 0 ? 0 : groups.size() / layers; }
+  const Participant::Id& id(uint participant) const { return (*ids)[participant]; }
+  GroupId group(uint participant, uint layer = 0) const { return groups[(std::size_t) participant * layers + layer]; }
+  Participant::Cost cost(uint participant, uint layer = 0) const {
+    return costs[(std::size_t) participant * layers + layer];
+  }
+};
+
 class Assignment{
 public:
 
@@ -68,18 +175,59 @@ public:
 
   Assignment(std::vector<Participant> participants,
              uint assignment_split = 0,
-             std::vector<std::pair<uint,uint>> forbidden_combinations = std::vector<std::pair<uint,uint>>());
+             std::vector<std::pair<uint,uint>> forbidden_combinations = std::vector<std::pair<uint,uint>>(),
+             SolverOptions options = SolverOptions());
+
+  Assignment(DensePreferences preferences,
+             uint assignment_split = 0,
+             std::vector<std::pair<uint,uint>> forbidden_combinations = std::vector<std::pair<uint,uint>>(),
+             SolverOptions options = SolverOptions());
+
+  // one independent assignment between each pair of split points. exclusive combinations need one split.
+  Assignment(DensePreferences preferences,
+             std::vector<uint> assignment_splits,
+             std::vector<std::pair<uint,uint>> forbidden_combinations = std::vector<std::pair<uint,uint>>(),
+             SolverOptions options = SolverOptions());
+
+  // sparse preferences are always solved with the flow solver
+  Assignment(SparsePreferences preferences, SolverOptions options = SolverOptions());
 
   std::vector<ParticipantAssignment> solve() const;
+  // same without a record per participant
+  AssignmentResult solveCompact() const;
 
 private:
-  const std::vector<Participant> m_Participants;
-  const uint m_AssignmentSplit;
+  const DensePreferences m_Preferences;
+  const std::vector<uint> m_AssignmentSplits;
   const std::vector<std::pair<uint,uint>> m_ForbiddenCombinations;
+  const SolverOptions m_Options;
+  const SparsePreferences m_SparsePreferences;
 };
 
+// stream of WARNING on the calling thread. the default stream unless set to another one.
+std::ostream& warning_stream();
+void set_warning_stream(std::ostream* stream);
+// stream of WARNING on threads which did not set their own. std::cerr unless set to another one.
+void set_default_warning_stream(std::ostream* stream);
+// writes one complete warning to warning_stream(), warnings of different threads do not interleave
+void write_warning(const std::string& text);
+
+// reports the certificate of --verify and the certificate statistics for a result of solveCompact
+// which was not solved by Assignment itself, e.g. one from ResultCache. splits sorted and in range
+void certify_result(const DensePreferences& preferences, const std::vector<uint>& splits,
+                    const AssignmentResult& result, const SolverOptions& options);
+
+// group of every participant in a single layer assignment, -1 when it could not be assigned
+std::vector<GroupId> solve_groups(const DensePreferences& preferences, const SolverOptions& options);
+
+// places per group when participants are spread evenly over the groups, rounded up
+uint group_capacity(uint participants, uint group_count);
+
 std::vector<std::string> split(const std::string& data, char delimiter);
-void print_assignments_csv(const std::vector<Assignment::ParticipantAssignment>& assignments, bool print_costs);
+Solver parse_solver(const std::string& name);
+SolverOptions parse_solver_options(const ProgArgs& args);
+void print_assignments_csv(const std::vector<Assignment::ParticipantAssignment>& assignments, bool print_costs,
+                           std::ostream& stream = std::cout);
 
 template<typename T>
 T parse(const std::string& data){
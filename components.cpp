@@ -0,0 +1,148 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <numeric>
+#include <algorithm>
+#include "components.h"
+#include "flow.h"
+#include "thread_pool.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+class DisjointSets {
+public:
+  explicit DisjointSets(uint size) : m_Parents(size) {
+    std::iota(m_Parents.begin(), m_Parents.end(), 0);
+  }
+
+  uint find(uint element){
+    while(m_Parents[element] != element){
+      m_Parents[element] = m_Parents[m_Parents[element]]; // path halving
+      element = m_Parents[element];
+    }
+    return element;
+  }
+
+  void unite(uint first, uint second){
+    first = find(first);
+    second = find(second);
+    if(first != second){
+      m_Parents[std::max(first, second)] = std::min(first, second);
+    }
+  }
+
+private:
+  std::vector<uint> m_Parents;
+};
+
+// preferences of the component with its groups numbered from 0
+SparsePreferences componentPreferences(const SparsePreferences& preferences, const SparseComponent& component,
+                                       const std::vector<GroupId>& local_groups)
+{
+  SparsePreferences result;
+  result.group_count = component.groups.size();
+  result.ids.reserve(component.participants.size());
+  result.offsets.reserve(component.participants.size() + 1);
+  for(uint participant : component.participants){
+    result.ids.push_back(preferences.ids[participant]);
+    for(uint index = preferences.offsets[participant]; index < preferences.offsets[participant + 1]; ++index){
+      result.groups.push_back(local_groups[preferences.groups[index]]);
+      result.costs.push_back(preferences.costs[index]);
+    }
+    result.offsets.push_back(result.groups.size());
+  }
+  return result;
+}
+
+} // namespace
+
+std::vector<SparseComponent> assign::sparse_components(const SparsePreferences& preferences){
+  DisjointSets sets(preferences.group_count);
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    for(uint index = preferences.offsets[participant] + 1; index < preferences.offsets[participant + 1]; ++index){
+      sets.unite(preferences.groups[preferences.offsets[participant]], preferences.groups[index]);
+    }
+  }
+  std::vector<SparseComponent> result;
+  std::vector<int> component_of(preferences.group_count, -1); // by root group
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    if(preferences.offsets[participant] == preferences.offsets[participant + 1]){
+      continue;
+    }
+    uint root = sets.find(preferences.groups[preferences.offsets[participant]]);
+    if(component_of[root] < 0){
+      component_of[root] = result.size();
+      result.push_back(SparseComponent());
+    }
+    result[component_of[root]].participants.push_back(participant);
+  }
+  for(uint group = 0; group < preferences.group_count; ++group){
+    int component = component_of[sets.find(group)];
+    if(component >= 0){
+      result[component].groups.push_back(group);
+    }
+  }
+  return result;
+}
+
+std::vector<GroupId> assign::component_assignment(const SparsePreferences& preferences, uint group_size,
+                                                  uint threads)
+{
+  std::vector<SparseComponent> components = sparse_components(preferences);
+  set_statistic("components", components.size());
+  if(components.size() <= 1){
+    return flow_assignment(preferences, group_size);
+  }
+  // the largest components start first so that the small ones fill the gaps
+  std::vector<uint> order(components.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&components](uint a, uint b){
+    return components[a].participants.size() > components[b].participants.size();
+  });
+  set_statistic("components.largest", components[order.front()].participants.size());
+
+  std::vector<GroupId> result(preferences.size(), -1);
+  ThreadPool pool(threads);
+  pool.parallel_for(components.size(), [&](uint begin, uint end){
+    std::vector<GroupId> local_groups(preferences.group_count, -1);
+    for(uint i = begin; i < end; ++i){
+      const SparseComponent& component = components[order[i]];
+      for(uint local = 0; local < component.groups.size(); ++local){
+        local_groups[component.groups[local]] = local;
+      }
+      std::vector<GroupId> groups = flow_assignment(componentPreferences(preferences, component, local_groups),
+                                                    group_size);
+      for(uint local = 0; local < groups.size(); ++local){ // every participant writes its own entry
+        result[component.participants[local]] = groups[local] < 0 ? -1 : component.groups[groups[local]];
+      }
+    }
+  }, 1);
+  return result;
+}
@@ -0,0 +1,52 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Participants and groups which are connected by listed preferences. Participants of different
+ * components never compete for a group, so every component can be solved on its own with the full
+ * capacity of its groups.
+ */
+struct SparseComponent {
+  std::vector<uint> participants; // in input order
+  std::vector<GroupId> groups;    // ascending
+};
+
+// components with at least one participant, ordered by their first participant. participants
+// without any listed group are left out
+std::vector<SparseComponent> sparse_components(const SparsePreferences& preferences);
+
+// same as flow_assignment on the whole preferences, with the components solved in parallel
+std::vector<GroupId> component_assignment(const SparsePreferences& preferences, uint group_size, uint threads);
+
+} // namespace assign
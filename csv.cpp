@@ -0,0 +1,303 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "csv.h"
+#include "common.h"
+
+using namespace assign;
+
+namespace {
+
+const static std::size_t BLOCK_SIZE = 1 << 20;
+
+// calls the handler for all complete lines and returns the start of the incomplete rest
+const char* handle_lines(const char* begin, const char* end, unsigned int& line, const LineHandler& handler){
+  while(begin < end){
+    const char* line_end = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    if(line_end == nullptr) break;
+    handler(begin, (line_end > begin && line_end[-1] == '\r') ? line_end - 1 : line_end, ++line);
+    begin = line_end + 1;
+  }
+  return begin;
+}
+
+void handle_last_line(const char* begin, const char* end, unsigned int& line, const LineHandler& handler){
+  if(begin < end){
+    handler(begin, (end[-1] == '\r') ? end - 1 : end, ++line);
+  }
+}
+
+bool is_space(char c){
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void check_cost(long long value, unsigned int line){
+  if(value > std::numeric_limits<Participant::Cost>::max() || value < std::numeric_limits<Participant::Cost>::min()){
+    ERROR(-1,"Cost " << value << " in line #" << line << " is out of range.");
+  }
+}
+
+// read only mapping of a regular file, unmapped when the handler throws as well.
+// mapped() is false for empty or special files which are read as a stream instead
+class MappedCsv {
+public:
+  explicit MappedCsv(const std::string& path){
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0){
+      ERROR(1,"Could not open input file '" << path << "'.");
+    }
+    struct stat status;
+    if(fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0){
+      m_Size = status.st_size;
+      m_Data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, file, 0);
+    }
+    close(file); // the mapping stays valid
+    if(m_Data != MAP_FAILED){
+      madvise(m_Data, m_Size, MADV_SEQUENTIAL);
+    }
+  }
+  ~MappedCsv(){
+    if(m_Data != MAP_FAILED){
+      munmap(m_Data, m_Size);
+    }
+  }
+  MappedCsv(const MappedCsv&) = delete;
+  MappedCsv& operator=(const MappedCsv&) = delete;
+
+  bool mapped() const { return m_Data != MAP_FAILED; }
+  const char* begin() const { return static_cast<const char*>(m_Data); }
+  const char* end() const { return begin() + m_Size; }
+
+private:
+  void* m_Data = MAP_FAILED;
+  std::size_t m_Size = 0;
+};
+
+} // namespace
+
+void assign::read_csv_lines(std::istream& stream, const LineHandler& handler){
+  std::vector<char> buffer(BLOCK_SIZE);
+  std::size_t filled = 0;
+  unsigned int line = 0;
+  while(stream){
+    if(filled == buffer.size()){ // a single line does not fit
+      buffer.resize(buffer.size() * 2);
+    }
+    stream.read(buffer.data() + filled, buffer.size() - filled);
+    filled += stream.gcount();
+    const char* rest = handle_lines(buffer.data(), buffer.data() + filled, line, handler);
+    filled = buffer.data() + filled - rest;
+    std::memmove(buffer.data(), rest, filled);
+  }
+  handle_last_line(buffer.data(), buffer.data() + filled, line, handler);
+}
+
+void assign::read_csv_lines(const std::string& path, const LineHandler& handler){
+  MappedCsv file(path);
+  if(!file.mapped()){
+    std::ifstream stream(path.c_str(), std::ios::binary);
+    read_csv_lines(stream, handler);
+    return;
+  }
+  unsigned int line = 0;
+  handle_last_line(handle_lines(file.begin(), file.end(), line, handler), file.end(), line, handler);
+}
+
+bool assign::next_field(const char*& cursor, const char* end, char delimiter,
+                        const char*& field_begin, const char*& field_end)
+{
+  if(cursor > end){
+    return false;
+  }
+  field_begin = cursor;
+  field_end = static_cast<const char*>(std::memchr(cursor, delimiter, end - cursor));
+  if(field_end == nullptr){
+    field_end = end;
+  }
+  cursor = field_end + 1;
+  return true;
+}
+
+void assign::trim(const char*& begin, const char*& end){
+  while(begin < end && is_space(*begin)) { ++begin; }
+  while(end > begin && is_space(end[-1])) { --end; }
+}
+
+bool assign::parse_integer(const char* begin, const char* end, long long& dst){
+  return parse_integer_field(begin, end, '\0', dst) && begin > end;
+}
+
+bool assign::parse_integer_field(const char*& cursor, const char* end, char delimiter, long long& dst){
+  while(cursor < end && is_space(*cursor)) { ++cursor; }
+  bool negative = cursor < end && *cursor == '-';
+  if(cursor < end && (*cursor == '-' || *cursor == '+')) { ++cursor; }
+  const char* digits = cursor;
+  long long value = 0;
+  while(cursor < end && static_cast<unsigned int>(*cursor - '0') <= 9){
+    value = value * 10 + (*cursor - '0');
+    ++cursor;
+  }
+  if(cursor == digits || cursor - digits > 18){
+    return false;
+  }
+  while(cursor < end && is_space(*cursor)) { ++cursor; }
+  if(cursor < end && *cursor != delimiter){
+    return false;
+  }
+  ++cursor;
+  dst = negative ? -value : value;
+  return true;
+}
+
+namespace {
+
+std::size_t file_size(const std::string& path){
+  struct stat status;
+  return (stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode)) ? status.st_size : 0;
+}
+
+// parses 'id,cost,cost,...' lines into a DensePreferences. the size of the input is used to
+// reserve memory for all lines after the first one.
+class DenseParser {
+public:
+  DenseParser(DensePreferences& dst, std::size_t bytes = 0) : m_Preferences(dst), m_Bytes(bytes) {}
+
+  void operator()(const char* begin, const char* end, unsigned int line){
+    std::size_t length = end - begin + 1;
+    trim(begin, end);
+    if(begin == end) return; // skip empty lines
+    const char *field_begin, *field_end;
+    next_field(begin, end, ',', field_begin, field_end);
+    trim(field_begin, field_end);
+    m_Preferences.ids.push_back(Participant::Id(field_begin, field_end));
+    uint count = 0;
+    while(begin < end){
+      const char* field = begin;
+      long long value;
+      if(!parse_integer_field(begin, end, ',', value)){
+        ERROR(-1,"Invalid cost '" << std::string(field, std::find(field, end, ',')) << "' in line #" << line << ".");
+      }
+      check_cost(value, line);
+      m_Preferences.costs.push_back(value);
+      ++count;
+    }
+    if(m_Preferences.size() == 1){
+      m_Preferences.group_count = count;
+      std::size_t lines = m_Bytes / length * 11 / 10 + 1;
+      m_Preferences.ids.reserve(lines);
+      m_Preferences.costs.reserve(lines * count);
+    } else if(count != m_Preferences.group_count){
+      ERROR(-1,"Preferences count in line #" << line << " is defferent from previous. "
+                << count << " != " << m_Preferences.group_count << "(previous).");
+    }
+  }
+
+private:
+  DensePreferences& m_Preferences;
+  const std::size_t m_Bytes;
+};
+
+// parses 'id,group:cost,group:cost,...' lines into a SparsePreferences
+class SparseParser {
+public:
+  SparseParser(SparsePreferences& dst) : m_Preferences(dst) {}
+
+  void operator()(const char* begin, const char* end, unsigned int line){
+    trim(begin, end);
+    if(begin == end) return; // skip empty lines
+    const char *field_begin, *field_end;
+    next_field(begin, end, ',', field_begin, field_end);
+    trim(field_begin, field_end);
+    m_Preferences.ids.push_back(Participant::Id(field_begin, field_end));
+    while(next_field(begin, end, ',', field_begin, field_end)){
+      if(field_begin == field_end && begin > end) break; // trailing comma
+      const char *group_begin = field_begin, *group_end = field_end;
+      const char* cursor = field_begin;
+      next_field(cursor, field_end, ':', group_begin, group_end);
+      long long group, cost;
+      if(group_end == field_end || !parse_integer(group_begin, group_end, group)
+         || !parse_integer(cursor, field_end, cost))
+      {
+        ERROR(-1,"Preference '" << std::string(field_begin, field_end) << "' in line #" << line
+                  << " is not of the form group:cost.");
+      }
+      if(group < 0 || group > std::numeric_limits<GroupId>::max()){
+        ERROR(-1,"Invalid group " << group << " in line #" << line << ".");
+      }
+      check_cost(cost, line);
+      m_Preferences.groups.push_back(group);
+      m_Preferences.costs.push_back(cost);
+      m_Preferences.group_count = std::max<uint>(m_Preferences.group_count, group + 1);
+    }
+    std::vector<GroupId> listed(m_Preferences.groups.begin() + m_Preferences.offsets.back(), m_Preferences.groups.end());
+    std::sort(listed.begin(), listed.end());
+    auto duplicate = std::adjacent_find(listed.begin(), listed.end());
+    if(duplicate != listed.end()){
+      ERROR(-1,"Group " << *duplicate << " is listed twice in line #" << line << ".");
+    }
+    m_Preferences.offsets.push_back(m_Preferences.groups.size());
+  }
+
+private:
+  SparsePreferences& m_Preferences;
+};
+
+} // namespace
+
+DensePreferences DensePreferences::fromCsv(std::istream& csv_stream){
+  DensePreferences result;
+  read_csv_lines(csv_stream, DenseParser(result));
+  return result;
+}
+
+DensePreferences DensePreferences::fromCsvFile(const std::string& path){
+  DensePreferences result;
+  read_csv_lines(path, DenseParser(result, file_size(path)));
+  return result;
+}
+
+SparsePreferences SparsePreferences::fromCsv(std::istream& csv_stream, uint group_count){
+  SparsePreferences result;
+  result.group_count = group_count;
+  read_csv_lines(csv_stream, SparseParser(result));
+  return result;
+}
+
+SparsePreferences SparsePreferences::fromCsvFile(const std::string& path, uint group_count){
+  SparsePreferences result;
+  result.group_count = group_count;
+  read_csv_lines(path, SparseParser(result));
+  return result;
+}
@@ -0,0 +1,61 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <istream>
+#include <functional>
+
+namespace assign {
+
+/**
+ * Line based reading of csv sources without copying every line into a string. Lines are passed as
+ * [begin,end) without the line break together with their number counting from 1.
+ */
+typedef std::function<void(const char* begin, const char* end, unsigned int line)> LineHandler;
+
+// reads the stream in large blocks
+void read_csv_lines(std::istream& stream, const LineHandler& handler);
+
+// memory maps the file. falls back to reading it as a stream when it can not be mapped.
+void read_csv_lines(const std::string& path, const LineHandler& handler);
+
+// moves cursor behind the next delimiter and returns the field before it in [begin,end)
+bool next_field(const char*& cursor, const char* end, char delimiter, const char*& field_begin, const char*& field_end);
+
+// strips surrounding whitespace
+void trim(const char*& begin, const char*& end);
+
+// parses a whole field as integer. returns false when it contains anything else
+bool parse_integer(const char* begin, const char* end, long long& dst);
+
+// parses an integer field at cursor and moves cursor behind the following delimiter. returns false
+// when the field is not an integer.
+bool parse_integer_field(const char*& cursor, const char* end, char delimiter, long long& dst);
+
+} // namespace assign
@@ -0,0 +1,403 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <queue>
+#include <limits>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+#include "flow.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Distance;
+
+const static Distance UNREACHED = std::numeric_limits<Distance>::max();
+const static uint NO_EDGE = std::numeric_limits<uint>::max();
+
+// all groups are acceptable for every participant
+class DenseCosts {
+public:
+  DenseCosts(const DensePreferences& preferences, uint group_size)
+    : m_Preferences(preferences), m_GroupSize(group_size)
+  {}
+  uint participants() const { return m_Preferences.size(); }
+  uint groups() const { return m_Preferences.group_count; }
+  uint edges() const { return participants() * groups(); }
+  uint capacity(GroupId) const { return m_GroupSize; }
+  uint degree(uint) const { return groups(); }
+  uint edge(uint participant, uint edge) const { return participant * groups() + edge; }
+  GroupId group(uint, uint edge) const { return edge; }
+  Distance cost(uint participant, uint edge) const { return m_Preferences.row(participant)[edge]; }
+private:
+  const DensePreferences& m_Preferences;
+  const uint m_GroupSize;
+};
+
+// only the listed groups are acceptable. every participant may also go to an additional group of
+// unassigned participants. it is more expensive than any change among the listed groups, so as
+// many participants as possible are assigned.
+class SparseCosts {
+public:
+  SparseCosts(const SparsePreferences& preferences, uint group_size)
+    : m_Preferences(preferences), m_GroupSize(group_size), m_Unassigned(1)
+  {
+    if(!preferences.costs.empty()){
+      auto range = std::minmax_element(preferences.costs.begin(), preferences.costs.end());
+      m_Unassigned = (Distance(*range.second) - *range.first + 1) * (preferences.size() + 1)
+                     + std::abs(Distance(*range.first)) + std::abs(Distance(*range.second));
+    }
+  }
+  uint participants() const { return m_Preferences.size(); }
+  uint groups() const { return m_Preferences.group_count + 1; }
+  uint edges() const { return m_Preferences.offsets.back() + participants(); }
+  GroupId unassigned() const { return m_Preferences.group_count; }
+  uint capacity(GroupId group) const {
+    return group == unassigned() ? std::numeric_limits<uint>::max() : m_GroupSize;
+  }
+  uint degree(uint participant) const {
+    return m_Preferences.offsets[participant + 1] - m_Preferences.offsets[participant] + 1;
+  }
+  uint edge(uint participant, uint edge) const { return m_Preferences.offsets[participant] + participant + edge; }
+  GroupId group(uint participant, uint edge) const {
+    uint index = m_Preferences.offsets[participant] + edge;
+    return index < m_Preferences.offsets[participant + 1] ? m_Preferences.groups[index] : unassigned();
+  }
+  Distance cost(uint participant, uint edge) const {
+    uint index = m_Preferences.offsets[participant] + edge;
+    return index < m_Preferences.offsets[participant + 1] ? m_Preferences.costs[index] : m_Unassigned;
+  }
+private:
+  const SparsePreferences& m_Preferences;
+  const uint m_GroupSize;
+  Distance m_Unassigned;
+};
+
+struct Move {
+  Distance delta; // cost change of the participant when moved
+  Distance cost;  // cost of the participant in the target group
+  uint participant;
+  uint from;      // edges of the participant
+  uint to;
+  uint stamp;
+
+  bool operator<(const Move& other) const { // inverted, std::priority_queue is a max heap
+    return (delta != other.delta) ? delta > other.delta : participant > other.participant;
+  }
+};
+
+struct Label {
+  Distance distance;
+  GroupId group;
+
+  bool operator<(const Label& other) const { // inverted, std::priority_queue is a max heap
+    return (distance != other.distance) ? distance > other.distance : group > other.group;
+  }
+};
+
+/**
+ * Every participant is a source with a supply of participants with the same preferences. The flow
+ * is kept per edge between participants and groups.
+ */
+template<typename Costs>
+class TransportationProblem {
+public:
+  TransportationProblem(const Costs& costs)
+    : m_Costs(costs), m_GroupCount(costs.groups()),
+      m_Flow(costs.edges(), 0), m_Stamps(costs.edges(), 0),
+      m_Members(m_GroupCount, 0), m_Potentials(m_GroupCount, 0), m_Outgoing(m_GroupCount),
+      m_Distances(m_GroupCount, UNREACHED), m_Previous(m_GroupCount), m_Moved(m_GroupCount),
+      m_Done(m_GroupCount, false)
+  {}
+
+  // sends up to supply units from a participant along a shortest augmenting path. returns the amount.
+  uint augment(uint participant, uint supply){
+    std::priority_queue<Label> queue;
+    for(uint edge = 0; edge < m_Costs.degree(participant); ++edge){
+      GroupId group = m_Costs.group(participant, edge);
+      Move move = { 0, m_Costs.cost(participant, edge), participant, NO_EDGE, m_Costs.edge(participant, edge), 0 };
+      reach(group, move.cost - m_Potentials[group], -1, move, queue);
+    }
+    GroupId sink = -1;
+    while(!queue.empty()){
+      GroupId current = queue.top().group;
+      queue.pop();
+      if(m_Done[current]) continue;
+      m_Done[current] = true;
+      m_Finished.push_back(current);
+      if(m_Members[current] < m_Costs.capacity(current)){
+        sink = current;
+        break;
+      }
+      for(uint index : m_Outgoing[current]){
+        GroupId to = m_MoveTargets[index];
+        Move move;
+        if(m_Done[to] || !bestMove(index, move)) continue;
+        reach(to, m_Distances[current] + move.delta + m_Potentials[current] - m_Potentials[to], current,
+              move, queue);
+      }
+    }
+    uint amount = 0;
+    if(sink >= 0){
+      for(GroupId group : m_Finished){
+        m_Potentials[group] += m_Distances[group] - m_Distances[sink];
+      }
+      amount = std::min(supply, m_Costs.capacity(sink) - m_Members[sink]);
+      for(GroupId group = sink; m_Previous[group] >= 0; group = m_Previous[group]){
+        amount = std::min(amount, m_Flow[m_Moved[group].from]);
+      }
+      m_Members[sink] += amount;
+      for(GroupId group = sink; group >= 0; group = m_Previous[group]){
+        const Move& move = m_Moved[group];
+        if(move.from != NO_EDGE){
+          m_Flow[move.from] -= amount;
+        }
+        addFlow(move.participant, move.to, group, move.cost, amount);
+      }
+    }
+    for(GroupId group : m_Touched){
+      m_Distances[group] = UNREACHED;
+      m_Done[group] = false;
+    }
+    m_Touched.clear();
+    m_Finished.clear();
+    return amount;
+  }
+
+  // flow on every edge between participants and groups
+  const std::vector<uint>& flow() const {
+    return m_Flow;
+  }
+
+private:
+  void reach(GroupId group, Distance distance, GroupId previous, const Move& move, std::priority_queue<Label>& queue){
+    if(distance >= m_Distances[group]) return;
+    if(m_Distances[group] == UNREACHED){
+      m_Touched.push_back(group);
+    }
+    m_Distances[group] = distance;
+    m_Previous[group] = previous;
+    m_Moved[group] = move;
+    Label label = { distance, group };
+    queue.push(label);
+  }
+
+  void addFlow(uint participant, uint edge, GroupId group, Distance cost, uint amount){
+    bool used = m_Flow[edge] > 0;
+    m_Flow[edge] += amount;
+    if(used) return;
+    uint stamp = ++m_Stamps[edge];
+    for(uint other = 0; other < m_Costs.degree(participant); ++other){
+      GroupId to = m_Costs.group(participant, other);
+      if(to != group){
+        Move move = { m_Costs.cost(participant, other) - cost, m_Costs.cost(participant, other), participant,
+                      edge, m_Costs.edge(participant, other), stamp };
+        m_Moves[moves(group, to)].push(move);
+      }
+    }
+  }
+
+  // cheapest participant currently in a group that can be moved along the edge
+  bool bestMove(uint index, Move& dst){
+    std::priority_queue<Move>& heap = m_Moves[index];
+    while(!heap.empty()){
+      const Move& top = heap.top();
+      if(m_Flow[top.from] > 0 && m_Stamps[top.from] == top.stamp){
+        dst = top;
+        return true;
+      }
+      heap.pop(); // participant moved away since
+    }
+    return false;
+  }
+
+  // index of the move heap between two groups. created on first use
+  uint moves(GroupId from, GroupId to){
+    unsigned long long key = (unsigned long long) from * m_GroupCount + to;
+    auto found = m_MoveIndex.find(key);
+    if(found != m_MoveIndex.end()){
+      return found->second;
+    }
+    uint index = m_Moves.size();
+    m_MoveIndex[key] = index;
+    m_Moves.push_back(std::priority_queue<Move>());
+    m_MoveTargets.push_back(to);
+    m_Outgoing[from].push_back(index);
+    return index;
+  }
+
+  const Costs& m_Costs;
+  const uint m_GroupCount;
+  std::vector<uint> m_Flow;
+  std::vector<uint> m_Stamps;
+  std::vector<uint> m_Members;
+  std::vector<Distance> m_Potentials;
+  // move candidates between pairs of groups
+  std::unordered_map<unsigned long long,uint> m_MoveIndex;
+  std::vector<std::priority_queue<Move>> m_Moves;
+  std::vector<GroupId> m_MoveTargets;
+  std::vector<std::vector<uint>> m_Outgoing;
+  // dijkstra state
+  std::vector<Distance> m_Distances;
+  std::vector<GroupId> m_Previous;
+  std::vector<Move> m_Moved;
+  std::vector<char> m_Done;
+  std::vector<GroupId> m_Touched;
+  std::vector<GroupId> m_Finished;
+};
+
+// participants with identical preferences are solved as one source
+struct Profiles {
+  std::vector<uint> representatives; // first participant of every profile
+  std::vector<uint> supplies;        // participants per profile
+  std::vector<uint> profiles;        // profile of every participant
+};
+
+struct ProfileHash {
+  std::size_t operator()(const std::vector<Participant::Cost>& profile) const {
+    std::size_t result = profile.size();
+    for(Participant::Cost cost : profile){
+      result ^= std::hash<Participant::Cost>()(cost) + 0x9e3779b9 + (result << 6) + (result >> 2);
+    }
+    return result;
+  }
+};
+
+template<typename Key>
+Profiles collapse(uint participants, const Key& key){
+  Profiles result;
+  result.profiles.reserve(participants);
+  std::unordered_map<std::vector<Participant::Cost>,uint,ProfileHash> known;
+  for(uint participant = 0; participant < participants; ++participant){
+    auto inserted = known.insert(std::make_pair(key(participant), (uint) result.representatives.size()));
+    if(inserted.second){
+      result.representatives.push_back(participant);
+      result.supplies.push_back(0);
+    }
+    ++result.supplies[inserted.first->second];
+    result.profiles.push_back(inserted.first->second);
+  }
+  return result;
+}
+
+template<typename Costs>
+std::vector<uint> transport(const Costs& costs, const std::vector<uint>& supplies){
+  TransportationProblem<Costs> problem(costs);
+  long long augmentations = 0;
+  for(uint participant = 0; participant < costs.participants(); ++participant){
+    uint supply = supplies[participant];
+    while(supply > 0){
+      uint amount = problem.augment(participant, supply);
+      ++augmentations;
+      if(amount == 0) break;
+      supply -= amount;
+    }
+  }
+  add_counter("flow.augmentations", augmentations);
+  add_counter("flow.profiles", costs.participants());
+  return problem.flow();
+}
+
+// participants of a profile get its groups in input order, lower groups first
+template<typename Costs>
+std::vector<GroupId> expand(const Costs& costs, const Profiles& profiles, std::vector<uint> flow){
+  std::vector<GroupId> result(profiles.profiles.size(), -1);
+  std::vector<uint> next(profiles.representatives.size(), 0);
+  for(uint participant = 0; participant < result.size(); ++participant){
+    uint profile = profiles.profiles[participant];
+    uint& edge = next[profile];
+    while(edge < costs.degree(profile) && flow[costs.edge(profile, edge)] == 0) { ++edge; }
+    if(edge < costs.degree(profile)){
+      --flow[costs.edge(profile, edge)];
+      result[participant] = costs.group(profile, edge);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+std::vector<GroupId> assign::flow_assignment(const DensePreferences& preferences, uint group_size){
+  if(preferences.size() == 0 || preferences.group_count == 0){
+    return std::vector<GroupId>(preferences.size(), -1);
+  }
+  Profiles profiles = collapse(preferences.size(), [&preferences](uint participant){
+    return std::vector<Participant::Cost>(preferences.row(participant),
+                                          preferences.row(participant) + preferences.group_count);
+  });
+  DensePreferences unique;
+  unique.group_count = preferences.group_count;
+  unique.ids.reserve(profiles.representatives.size());
+  unique.costs.reserve((std::size_t) profiles.representatives.size() * unique.group_count);
+  for(uint representative : profiles.representatives){
+    unique.ids.push_back(preferences.ids[representative]);
+    unique.costs.insert(unique.costs.end(), preferences.row(representative),
+                        preferences.row(representative) + preferences.group_count);
+  }
+  DenseCosts costs(unique, group_size);
+  return expand(costs, profiles, transport(costs, profiles.supplies));
+}
+
+std::vector<GroupId> assign::flow_assignment(const SparsePreferences& preferences, uint group_size){
+  if(preferences.group_count == 0){
+    return std::vector<GroupId>(preferences.size(), -1);
+  }
+  Profiles profiles = collapse(preferences.size(), [&preferences](uint participant){
+    std::vector<std::pair<GroupId,Participant::Cost>> listed;
+    for(uint index = preferences.offsets[participant]; index < preferences.offsets[participant + 1]; ++index){
+      listed.push_back(std::make_pair(preferences.groups[index], preferences.costs[index]));
+    }
+    std::sort(listed.begin(), listed.end());
+    std::vector<Participant::Cost> key;
+    for(const std::pair<GroupId,Participant::Cost>& preference : listed){
+      key.push_back(preference.first);
+      key.push_back(preference.second);
+    }
+    return key;
+  });
+  SparsePreferences unique;
+  unique.group_count = preferences.group_count;
+  for(uint representative : profiles.representatives){
+    unique.ids.push_back(preferences.ids[representative]);
+    for(uint index = preferences.offsets[representative]; index < preferences.offsets[representative + 1]; ++index){
+      unique.groups.push_back(preferences.groups[index]);
+      unique.costs.push_back(preferences.costs[index]);
+    }
+    unique.offsets.push_back(unique.groups.size());
+  }
+  SparseCosts costs(unique, group_size);
+  std::vector<GroupId> result = expand(costs, profiles, transport(costs, profiles.supplies));
+  for(GroupId& group : result){
+    if(group == costs.unassigned()){
+      group = -1;
+    }
+  }
+  return result;
+}
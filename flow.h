@@ -0,0 +1,53 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Solves the assignment as a transportation problem. Groups are nodes with a capacity of
+ * group_size participants instead of group_size replicated matrix rows. Participants are added
+ * along shortest augmenting paths between the groups, which keeps the memory at
+ * O(participants * groups). Participants with identical preferences are collapsed into one weighted
+ * source before solving and get their groups in input order afterwards.
+ *
+ * Returns the assigned group for every participant or -1 when it could not be assigned.
+ */
+std::vector<GroupId> flow_assignment(const DensePreferences& preferences, uint group_size);
+
+/**
+ * Same for sparse preferences. Only the listed groups are considered, the time and memory scale
+ * with the number of listed preferences. Participants which can not be placed in any of their
+ * groups are not assigned.
+ */
+std::vector<GroupId> flow_assignment(const SparsePreferences& preferences, uint group_size);
+
+} // namespace assign
@@ -0,0 +1,403 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <limits>
+#include <algorithm>
+#include "incremental.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Distance;
+
+const static Distance UNREACHED = std::numeric_limits<Distance>::max();
+
+struct Label {
+  Distance distance;
+  GroupId group;
+
+  bool operator<(const Label& other) const { // inverted, std::priority_queue is a max heap
+    return (distance != other.distance) ? distance > other.distance : group > other.group;
+  }
+};
+
+} // namespace
+
+IncrementalAssignment::IncrementalAssignment(uint group_count)
+  : m_GroupCount(group_count), m_Members(group_count, 0), m_Prices(group_count, 0),
+    m_Moves((std::size_t) group_count * group_count), m_Distances(group_count, UNREACHED),
+    m_Next(group_count, -1), m_Moved(group_count, 0), m_Done(group_count, false)
+{}
+
+bool IncrementalAssignment::add(const Participant::Id& id, const std::vector<Participant::Cost>& preferences){
+  if(m_GroupCount == 0 || preferences.size() != m_GroupCount || m_Slots.count(id)){
+    return false;
+  }
+  uint participant = allocate(id, preferences);
+  ++m_Count;
+  adjustCapacity();
+  insert(participant);
+  return true;
+}
+
+bool IncrementalAssignment::add(const DensePreferences& preferences){
+  if(m_GroupCount == 0 || preferences.group_count != m_GroupCount){
+    return false;
+  }
+  std::vector<uint> added;
+  for(uint i = 0; i < preferences.size(); ++i){
+    if(m_Slots.count(preferences.ids[i])){
+      continue;
+    }
+    added.push_back(allocate(preferences.ids[i], std::vector<Participant::Cost>(
+                               preferences.row(i), preferences.row(i) + m_GroupCount)));
+  }
+  m_Count += added.size();
+  adjustCapacity();
+  for(uint participant : added){
+    insert(participant);
+  }
+  return added.size() == preferences.size();
+}
+
+bool IncrementalAssignment::seed(const DensePreferences& preferences, const std::vector<GroupId>& groups,
+                                 const std::vector<long long>& prices)
+{
+  if(m_GroupCount == 0 || m_Count > 0 || !m_Free.empty() || preferences.group_count != m_GroupCount
+     || groups.size() != preferences.size() || prices.size() != m_GroupCount){
+    return false;
+  }
+  uint capacity = group_capacity(preferences.size(), m_GroupCount);
+  std::vector<uint> members(m_GroupCount, 0);
+  for(uint i = 0; i < preferences.size(); ++i){
+    GroupId group = groups[i];
+    if(group < 0 || group >= (GroupId) m_GroupCount || ++members[group] > capacity){
+      return false;
+    }
+    const Participant::Cost* row = preferences.row(i);
+    for(GroupId other = 0; other < (GroupId) m_GroupCount; ++other){
+      if(row[other] + prices[other] < row[group] + prices[group]){
+        return false;
+      }
+    }
+  }
+  std::unordered_map<Participant::Id,uint> ids;
+  for(uint i = 0; i < preferences.size(); ++i){
+    if(!ids.insert(std::make_pair(preferences.ids[i], i)).second){
+      return false;
+    }
+  }
+  for(GroupId group = 0; group < (GroupId) m_GroupCount; ++group){
+    if(prices[group] < 0 || (prices[group] > 0 && members[group] < capacity)){
+      return false;
+    }
+  }
+  m_Prices = prices;
+  m_Count = preferences.size();
+  m_Capacity = capacity;
+  for(uint i = 0; i < preferences.size(); ++i){
+    place(allocate(preferences.ids[i], std::vector<Participant::Cost>(preferences.row(i), preferences.row(i) + m_GroupCount)),
+          groups[i]);
+  }
+  for(uint participant : m_ChangedList){ // the seeded groups are no change
+    m_Changed[participant] = false;
+  }
+  m_ChangedList.clear();
+  return true;
+}
+
+bool IncrementalAssignment::update(const Participant::Id& id, const std::vector<Participant::Cost>& preferences){
+  auto found = m_Slots.find(id);
+  if(found == m_Slots.end() || preferences.size() != m_GroupCount){
+    return false;
+  }
+  uint participant = found->second;
+  vacate(participant);
+  std::copy(preferences.begin(), preferences.end(), m_Costs.begin() + (std::size_t) participant * m_GroupCount);
+  insert(participant);
+  return true;
+}
+
+bool IncrementalAssignment::remove(const Participant::Id& id){
+  auto found = m_Slots.find(id);
+  if(found == m_Slots.end()){
+    return false;
+  }
+  uint participant = found->second;
+  vacate(participant);
+  m_Slots.erase(found);
+  m_Free.push_back(participant);
+  --m_Count;
+  adjustCapacity();
+  return true;
+}
+
+GroupId IncrementalAssignment::group(const Participant::Id& id) const {
+  auto found = m_Slots.find(id);
+  return found == m_Slots.end() ? -1 : m_Groups[found->second];
+}
+
+std::vector<Assignment::ParticipantAssignment> IncrementalAssignment::assignments() const {
+  std::vector<uint> participants;
+  participants.reserve(m_Slots.size());
+  for(const auto& slot : m_Slots){
+    participants.push_back(slot.second);
+  }
+  std::sort(participants.begin(), participants.end(), [this](uint a, uint b){
+    return m_Sequences[a] < m_Sequences[b];
+  });
+  std::vector<Assignment::ParticipantAssignment> result;
+  result.reserve(participants.size());
+  for(uint participant : participants){
+    result.push_back(assignment(participant));
+  }
+  return result;
+}
+
+std::vector<Assignment::ParticipantAssignment> IncrementalAssignment::changed(){
+  std::vector<Assignment::ParticipantAssignment> result;
+  for(uint participant : m_ChangedList){
+    m_Changed[participant] = false;
+    if(m_Groups[participant] >= 0){
+      result.push_back(assignment(participant));
+    }
+  }
+  m_ChangedList.clear();
+  return result;
+}
+
+uint IncrementalAssignment::allocate(const Participant::Id& id, const std::vector<Participant::Cost>& preferences){
+  uint participant;
+  if(m_Free.empty()){
+    participant = m_Ids.size();
+    m_Ids.push_back(id);
+    m_Costs.insert(m_Costs.end(), preferences.begin(), preferences.end());
+    m_Groups.push_back(-1);
+    m_Stamps.push_back(0);
+    m_Sequences.push_back(0);
+    m_Changed.push_back(false);
+  } else {
+    participant = m_Free.back();
+    m_Free.pop_back();
+    m_Ids[participant] = id;
+    std::copy(preferences.begin(), preferences.end(), m_Costs.begin() + (std::size_t) participant * m_GroupCount);
+  }
+  m_Sequences[participant] = m_Sequence++;
+  m_Slots[id] = participant;
+  return participant;
+}
+
+void IncrementalAssignment::place(uint participant, GroupId group){
+  m_Groups[participant] = group;
+  ++m_Members[group];
+  m_Total += cost(participant, group);
+  uint stamp = ++m_Stamps[participant];
+  for(GroupId to = 0; to < (GroupId) m_GroupCount; ++to){
+    if(to != group){
+      Move move = { (Distance) cost(participant, to) - cost(participant, group), participant, stamp };
+      m_Moves[(std::size_t) group * m_GroupCount + to].push(move);
+    }
+  }
+  if(!m_Changed[participant]){
+    m_Changed[participant] = true;
+    m_ChangedList.push_back(participant);
+  }
+}
+
+void IncrementalAssignment::unplace(uint participant){
+  --m_Members[m_Groups[participant]];
+  m_Total -= cost(participant, m_Groups[participant]);
+  m_Groups[participant] = -1;
+  ++m_Stamps[participant];
+}
+
+// cheapest participant currently in a group that can be moved to another one
+bool IncrementalAssignment::bestMove(GroupId from, GroupId to, Move& dst){
+  std::priority_queue<Move>& heap = m_Moves[(std::size_t) from * m_GroupCount + to];
+  if(heap.size() > 2 * m_Members[from] + 64){ // drop participants which moved away since
+    std::vector<Move> valid;
+    valid.reserve(m_Members[from]);
+    for(; !heap.empty(); heap.pop()){
+      if(m_Groups[heap.top().participant] == from && m_Stamps[heap.top().participant] == heap.top().stamp){
+        valid.push_back(heap.top());
+      }
+    }
+    heap = std::priority_queue<Move>(valid.begin(), valid.end());
+  }
+  while(!heap.empty()){
+    const Move& top = heap.top();
+    if(m_Groups[top.participant] == from && m_Stamps[top.participant] == top.stamp){
+      dst = top;
+      return true;
+    }
+    heap.pop();
+  }
+  return false;
+}
+
+// places a participant along a shortest path to a group with a free place. full groups on the
+// path pass one of their participants on.
+void IncrementalAssignment::insert(uint participant){
+  std::priority_queue<Label> queue;
+  std::vector<GroupId> touched;
+  std::vector<GroupId> finished;
+  auto reach = [&](GroupId group, Distance distance, GroupId previous, uint moved){
+    if(distance >= m_Distances[group]) return;
+    if(m_Distances[group] == UNREACHED) touched.push_back(group);
+    m_Distances[group] = distance;
+    m_Next[group] = previous;
+    m_Moved[group] = moved;
+    Label label = { distance, group };
+    queue.push(label);
+  };
+  for(GroupId group = 0; group < (GroupId) m_GroupCount; ++group){
+    reach(group, cost(participant, group) + m_Prices[group], -1, participant);
+  }
+  GroupId sink = -1;
+  while(!queue.empty()){
+    GroupId current = queue.top().group;
+    queue.pop();
+    if(m_Done[current]) continue;
+    m_Done[current] = true;
+    finished.push_back(current);
+    if(m_Members[current] < m_Capacity){
+      sink = current;
+      break;
+    }
+    for(GroupId to = 0; to < (GroupId) m_GroupCount; ++to){
+      Move move;
+      if(m_Done[to] || !bestMove(current, to, move)) continue;
+      reach(to, m_Distances[current] + move.delta + m_Prices[to] - m_Prices[current], current, move.participant);
+    }
+  }
+  assert(sink >= 0);
+  for(GroupId group : finished){
+    m_Prices[group] += m_Distances[sink] - m_Distances[group];
+  }
+  for(GroupId group = sink; group >= 0; group = m_Next[group]){
+    uint moved = m_Moved[group];
+    if(m_Groups[moved] >= 0) unplace(moved);
+    place(moved, group);
+  }
+  for(GroupId group : touched){
+    m_Distances[group] = UNREACHED;
+    m_Done[group] = false;
+  }
+}
+
+// a group with a price got a free place. either a shortest chain of moves ending in the group
+// fills it or the price drops until the place is not wanted anymore. the free place ends up in
+// a group without a price.
+void IncrementalAssignment::refill(GroupId group){
+  std::priority_queue<Label> queue;
+  std::vector<GroupId> touched;
+  std::vector<GroupId> finished;
+  auto reach = [&](GroupId node, Distance distance, GroupId next, uint moved){
+    if(distance >= m_Distances[node]) return;
+    if(m_Distances[node] == UNREACHED) touched.push_back(node);
+    m_Distances[node] = distance;
+    m_Next[node] = next;
+    m_Moved[node] = moved;
+    Label label = { distance, node };
+    queue.push(label);
+  };
+  reach(group, 0, -1, 0);
+  Distance bound = m_Prices[group];
+  GroupId origin = group;
+  while(!queue.empty() && queue.top().distance < bound){
+    GroupId current = queue.top().group;
+    queue.pop();
+    if(m_Done[current]) continue;
+    m_Done[current] = true;
+    finished.push_back(current);
+    if(m_Distances[current] + m_Prices[current] < bound){
+      bound = m_Distances[current] + m_Prices[current];
+      origin = current;
+    }
+    for(GroupId from = 0; from < (GroupId) m_GroupCount; ++from){
+      Move move;
+      if(m_Done[from] || !bestMove(from, current, move)) continue;
+      reach(from, m_Distances[current] + move.delta + m_Prices[current] - m_Prices[from], current, move.participant);
+    }
+  }
+  for(GroupId node : finished){
+    m_Prices[node] -= bound - m_Distances[node];
+  }
+  for(GroupId from = origin; from != group; from = m_Next[from]){
+    uint moved = m_Moved[from];
+    unplace(moved);
+    place(moved, m_Next[from]);
+  }
+  for(GroupId node : touched){
+    m_Distances[node] = UNREACHED;
+    m_Done[node] = false;
+  }
+}
+
+// takes a participant out of its group and keeps the remaining assignment optimal
+void IncrementalAssignment::vacate(uint participant){
+  GroupId group = m_Groups[participant];
+  unplace(participant);
+  if(m_Prices[group] > 0){
+    refill(group);
+  }
+}
+
+void IncrementalAssignment::adjustCapacity(){
+  uint capacity = group_capacity(m_Count, m_GroupCount);
+  while(m_Capacity < capacity){
+    ++m_Capacity;
+    for(GroupId group = 0; group < (GroupId) m_GroupCount; ++group){
+      if(m_Prices[group] > 0 && m_Members[group] < m_Capacity){
+        refill(group);
+      }
+    }
+  }
+  while(m_Capacity > capacity){
+    --m_Capacity;
+    std::vector<uint> evicted;
+    for(GroupId group = 0; group < (GroupId) m_GroupCount; ++group){
+      Move move;
+      if(m_Members[group] > m_Capacity && bestMove(group, (group + 1) % m_GroupCount, move)){
+        evicted.push_back(move.participant);
+        unplace(move.participant);
+      }
+    }
+    for(uint participant : evicted){
+      insert(participant);
+    }
+  }
+}
+
+Assignment::ParticipantAssignment IncrementalAssignment::assignment(uint participant) const {
+  Assignment::ParticipantAssignment result;
+  result.participant = m_Ids[participant];
+  result.assigned_groups.push_back(m_Groups[participant]);
+  result.costs.push_back(cost(participant, m_Groups[participant]));
+  return result;
+}
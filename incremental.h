@@ -0,0 +1,123 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Keeps an optimal assignment of participants to groups of ceil(participants / groups) while
+ * participants are added, removed or changed. Next to the assignment every group has a price which
+ * proves its optimality: every participant is in the group where cost + price is lowest and only
+ * full groups have a price. A change only repairs these conditions with shortest paths between
+ * the groups starting from the previous solution instead of solving everything again.
+ */
+class IncrementalAssignment {
+public:
+  explicit IncrementalAssignment(uint group_count);
+
+  // these return false when the id is unknown / already known or the preference count is wrong
+  bool add(const Participant::Id& id, const std::vector<Participant::Cost>& preferences);
+  bool update(const Participant::Id& id, const std::vector<Participant::Cost>& preferences);
+  bool remove(const Participant::Id& id);
+  // adds many participants with one capacity change
+  bool add(const DensePreferences& preferences);
+  // starts from an optimal assignment and the group prices which prove it (see certificate.h)
+  // instead of adding the participants. false when it is not empty, the ids are not unique or the
+  // prices do not prove the assignment
+  bool seed(const DensePreferences& preferences, const std::vector<GroupId>& groups,
+            const std::vector<long long>& prices);
+
+  uint size() const { return m_Count; }
+  uint groupCount() const { return m_GroupCount; }
+  // -1 for unknown participants
+  GroupId group(const Participant::Id& id) const;
+  long long cost() const { return m_Total; }
+  const std::vector<long long>& prices() const { return m_Prices; }
+  // all participants in the order they were added
+  std::vector<Assignment::ParticipantAssignment> assignments() const;
+  // participants whose group was set since the last call, removed participants are left out
+  std::vector<Assignment::ParticipantAssignment> changed();
+
+private:
+  typedef long long Distance;
+
+  struct Move {
+    Distance delta; // cost change of the participant when moved
+    uint participant;
+    uint stamp;
+
+    bool operator<(const Move& other) const { // inverted, std::priority_queue is a max heap
+      return (delta != other.delta) ? delta > other.delta : participant > other.participant;
+    }
+  };
+
+  uint allocate(const Participant::Id& id, const std::vector<Participant::Cost>& preferences);
+  Participant::Cost cost(uint participant, GroupId group) const {
+    return m_Costs[(std::size_t) participant * m_GroupCount + group];
+  }
+  void place(uint participant, GroupId group);
+  void unplace(uint participant);
+  bool bestMove(GroupId from, GroupId to, Move& dst);
+  void insert(uint participant);
+  void refill(GroupId group);
+  void vacate(uint participant);
+  void adjustCapacity();
+  Assignment::ParticipantAssignment assignment(uint participant) const;
+
+  const uint m_GroupCount;
+  uint m_Capacity = 0;
+  uint m_Count = 0;
+  uint m_Sequence = 0;
+  long long m_Total = 0;
+  // participants by slot. slots of removed participants are reused
+  std::unordered_map<Participant::Id,uint> m_Slots;
+  std::vector<uint> m_Free;
+  std::vector<Participant::Id> m_Ids;
+  std::vector<Participant::Cost> m_Costs;
+  std::vector<GroupId> m_Groups;
+  std::vector<uint> m_Stamps;
+  std::vector<uint> m_Sequences;
+  std::vector<char> m_Changed;
+  std::vector<uint> m_ChangedList;
+  // groups
+  std::vector<uint> m_Members;
+  std::vector<Distance> m_Prices;
+  std::vector<std::priority_queue<Move>> m_Moves; // from * groups + to
+  // shortest path state
+  std::vector<Distance> m_Distances;
+  std::vector<GroupId> m_Next;
+  std::vector<uint> m_Moved;
+  std::vector<char> m_Done;
+};
+
+} // namespace assign
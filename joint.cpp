@@ -0,0 +1,296 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "joint.h"
+#include "flow.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Distance;
+
+// multipliers are integers in 1/SCALE of a cost unit
+const static Distance SCALE = 64;
+// halve the step when the bound did not improve for this many iterations
+const static uint STALL_ITERATIONS = 5;
+// alternating repairs of one layer with the other one fixed
+const static uint REPAIR_ROUNDS = 4;
+
+class JointProblem {
+public:
+  JointProblem(const DensePreferences& first, const DensePreferences& second,
+               const std::vector<std::pair<uint,uint>>& forbidden)
+    : m_First(first), m_Second(second), m_Forbidden((std::size_t) first.group_count * second.group_count, false)
+  {
+    for(const std::pair<uint,uint>& pair : forbidden){
+      if(pair.first < first.group_count && pair.second < second.group_count){
+        m_Forbidden[(std::size_t) pair.first * second.group_count + pair.second] = true;
+      }
+    }
+    // a violation is more expensive than any change of the costs
+    Distance range = 1;
+    for(const DensePreferences* layer : { &first, &second }){
+      if(layer->cost_count() > 0){
+        auto minmax = std::minmax_element(layer->data(), layer->data() + layer->cost_count());
+        range += Distance(*minmax.second) - *minmax.first;
+      }
+    }
+    m_Penalty = (Participant::Cost) std::min<Distance>(range * (first.size() + 1),
+                                                       std::numeric_limits<Participant::Cost>::max() / 4);
+  }
+
+  bool forbidden(GroupId first, GroupId second) const {
+    return m_Forbidden[(std::size_t) first * m_Second.group_count + second];
+  }
+
+  Distance cost(const std::vector<GroupId>& first, const std::vector<GroupId>& second) const {
+    Distance result = 0;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      result += m_First.row(participant)[first[participant]] + m_Second.row(participant)[second[participant]];
+    }
+    return result;
+  }
+
+  uint violations(const std::vector<GroupId>& first, const std::vector<GroupId>& second) const {
+    uint result = 0;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      result += forbidden(first[participant], second[participant]);
+    }
+    return result;
+  }
+
+  // first layer with the second one priced by the multipliers. every participant takes the cheapest
+  // allowed second group for each first group. returns the scaled bound or the lowest value when some
+  // participant could not avoid a forbidden combination. fits is false when the scaled costs of a
+  // participant span more than the costs of the flow solver can hold, nothing is solved then.
+  Distance relax(const std::vector<Distance>& multipliers, std::vector<GroupId>& first, std::vector<GroupId>& second,
+                 bool& fits){
+    uint groups = m_First.group_count;
+    DensePreferences relaxed;
+    relaxed.ids = m_First.ids;
+    relaxed.group_count = groups;
+    relaxed.costs.resize(m_First.cost_count());
+    std::vector<GroupId> choices((std::size_t) m_First.size() * groups, -1);
+    std::vector<Distance> values(m_First.cost_count(), 0);
+    // every participant takes one group, so its values are shifted to start at 0
+    std::vector<Distance> offsets(m_First.size(), 0);
+    Distance highest = 0;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      Distance lowest = std::numeric_limits<Distance>::max();
+      for(GroupId group = 0; group < (GroupId) groups; ++group){
+        std::size_t index = (std::size_t) participant * groups + group;
+        Distance best = std::numeric_limits<Distance>::max();
+        for(GroupId other = 0; other < (GroupId) m_Second.group_count; ++other){
+          Distance value = SCALE * m_Second.row(participant)[other] + multipliers[other];
+          if(value < best && !forbidden(group, other)){
+            best = value;
+            choices[index] = other;
+          }
+        }
+        if(choices[index] >= 0){
+          values[index] = SCALE * m_First.row(participant)[group] + best;
+          lowest = std::min(lowest, values[index]);
+        }
+      }
+      if(lowest != std::numeric_limits<Distance>::max()){
+        offsets[participant] = lowest;
+        for(GroupId group = 0; group < (GroupId) groups; ++group){
+          std::size_t index = (std::size_t) participant * groups + group;
+          if(choices[index] >= 0){
+            values[index] -= lowest;
+            highest = std::max(highest, values[index]);
+          }
+        }
+      }
+    }
+    const Distance limit = std::numeric_limits<Participant::Cost>::max() / 4;
+    fits = highest < limit;
+    if(!fits){
+      return std::numeric_limits<Distance>::min();
+    }
+    // groups without allowed partner are only taken when there is no other way
+    Distance penalty = std::min<Distance>((highest + 1) * (m_First.size() + 1) + highest, limit);
+    for(std::size_t index = 0; index < values.size(); ++index){
+      relaxed.costs[index] = (Participant::Cost) (choices[index] < 0 ? penalty : values[index]);
+    }
+    first = flow_assignment(relaxed, group_capacity(m_First.size(), groups));
+    second.resize(first.size());
+    Distance result = 0;
+    bool valid = true;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      second[participant] = choices[(std::size_t) participant * groups + first[participant]];
+      if(second[participant] < 0){
+        second[participant] = 0;
+        valid = false;
+      }
+      result += relaxed.row(participant)[first[participant]] + offsets[participant];
+    }
+    if(!valid){ // penalties are no costs, the value is no bound
+      return std::numeric_limits<Distance>::min();
+    }
+    uint size = group_capacity(m_Second.size(), m_Second.group_count);
+    for(Distance multiplier : multipliers){
+      result -= multiplier * size;
+    }
+    return result;
+  }
+
+  // solves one layer with the groups of the other one fixed
+  std::vector<GroupId> repair(const DensePreferences& layer, const std::vector<GroupId>& fixed, bool fixed_first){
+    DensePreferences penalized = layer;
+    for(uint participant = 0; participant < layer.size(); ++participant){
+      for(GroupId group = 0; group < (GroupId) layer.group_count; ++group){
+        bool violated = fixed_first ? forbidden(fixed[participant], group) : forbidden(group, fixed[participant]);
+        if(violated){
+          penalized.row(participant)[group] += m_Penalty;
+        }
+      }
+    }
+    return flow_assignment(penalized, group_capacity(layer.size(), layer.group_count));
+  }
+
+  // feasible assignment close to the relaxed one. keeps its first layer and alternates between the layers
+  void improve(std::vector<GroupId> first, JointAssignment& best, bool& found){
+    std::vector<GroupId> second = repair(m_Second, first, true);
+    for(uint round = 0; round < REPAIR_ROUNDS; ++round){
+      uint violations = this->violations(first, second);
+      Distance cost = this->cost(first, second);
+      bool better = !found || violations < best.violations || (violations == best.violations && cost < best.cost);
+      if(!better){
+        break;
+      }
+      found = true;
+      best.first = first;
+      best.second = second;
+      best.cost = cost;
+      best.violations = violations;
+      first = repair(m_First, second, false);
+      second = repair(m_Second, first, true);
+    }
+  }
+
+private:
+  const DensePreferences& m_First;
+  const DensePreferences& m_Second;
+  std::vector<char> m_Forbidden;
+  Participant::Cost m_Penalty;
+};
+
+Distance ceilDivide(Distance value, Distance divisor){
+  return value >= 0 ? (value + divisor - 1) / divisor : -((-value) / divisor);
+}
+
+} // namespace
+
+JointAssignment assign::joint_assignment(const DensePreferences& first, const DensePreferences& second,
+                                         const std::vector<std::pair<uint,uint>>& forbidden, uint iterations,
+                                         std::chrono::steady_clock::time_point deadline)
+{
+  assert(first.size() == second.size());
+  JointAssignment result;
+  if(first.size() == 0 || first.group_count == 0 || second.group_count == 0){
+    result.first.assign(first.size(), -1);
+    result.second.assign(first.size(), -1);
+    return result;
+  }
+  JointProblem problem(first, second, forbidden);
+  std::vector<Distance> multipliers(second.group_count, 0);
+  uint size = group_capacity(second.size(), second.group_count);
+  Distance bound = std::numeric_limits<Distance>::min();
+  double step = 2.;
+  uint stall = 0;
+  bool found = false;
+  std::vector<GroupId> relaxed_first, relaxed_second;
+  for(result.iterations = 0; result.iterations < std::max(1u, iterations); ){
+    ++result.iterations;
+    bool fits = true;
+    Distance value = problem.relax(multipliers, relaxed_first, relaxed_second, fits);
+    if(!fits){
+      result.relaxed = found || !result.first.empty();
+      break; // larger multipliers would not fit either
+    }
+    if(value > bound){
+      bound = value;
+      stall = 0;
+    } else if(++stall >= STALL_ITERATIONS){
+      step /= 2;
+      stall = 0;
+    }
+    std::vector<int> loads(second.group_count, 0);
+    for(GroupId group : relaxed_second){
+      ++loads[group];
+    }
+    bool feasible = problem.violations(relaxed_first, relaxed_second) == 0;
+    for(int load : loads){
+      feasible = feasible && load <= (int) size;
+    }
+    if(feasible){
+      Distance cost = problem.cost(relaxed_first, relaxed_second);
+      if(!found || result.violations > 0 || cost < result.cost){
+        found = true;
+        result.first = relaxed_first;
+        result.second = relaxed_second;
+        result.cost = cost;
+        result.violations = 0;
+      }
+    }
+    problem.improve(relaxed_first, result, found);
+    if(value == std::numeric_limits<Distance>::min()){
+      break; // the forbidden combinations can not be avoided
+    }
+    if(result.violations == 0 && result.cost <= ceilDivide(bound, SCALE)){
+      break; // proven optimal
+    }
+    if(std::chrono::steady_clock::now() >= deadline){
+      break;
+    }
+    // projected subgradient step towards the capacities of the second layer
+    double norm = 0;
+    std::vector<double> gradient(second.group_count);
+    for(uint group = 0; group < second.group_count; ++group){
+      gradient[group] = loads[group] - (double) size;
+      if(multipliers[group] == 0 && gradient[group] < 0){
+        gradient[group] = 0;
+      }
+      norm += gradient[group] * gradient[group];
+    }
+    if(norm == 0){
+      break; // the relaxed solution is feasible and no multiplier can raise the bound
+    }
+    double gap = std::max<double>(SCALE * result.cost - (double) value, SCALE);
+    for(uint group = 0; group < second.group_count; ++group){
+      Distance change = (Distance) std::llround(step * gap * gradient[group] / norm);
+      multipliers[group] = std::max<Distance>(0, multipliers[group] + change);
+    }
+  }
+  result.lower_bound = bound == std::numeric_limits<Distance>::min() ? bound : ceilDivide(bound, SCALE);
+  return result;
+}
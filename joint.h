@@ -0,0 +1,62 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include "common.h"
+
+namespace assign {
+
+struct JointAssignment {
+  std::vector<GroupId> first;  // group of every participant in the first layer
+  std::vector<GroupId> second; // and in the second, counted from 0
+  long long cost = 0;          // of the best assignment found
+  long long lower_bound = 0;   // no assignment can be cheaper. equal to cost when optimal, lowest
+                               // value when the forbidden combinations can not be avoided
+  uint violations = 0;         // forbidden combinations in the result when they could not be avoided
+  uint iterations = 0;
+  bool relaxed = true;         // false when the scaled costs did not fit the flow solver before
+                               // any assignment was found, the other fields are not set then
+};
+
+/**
+ * Assigns participants to one group of each layer at once while avoiding the forbidden (first, second)
+ * combinations. The group capacities of the second layer are moved into the costs with lagrangian
+ * multipliers, which leaves a transportation problem over the first layer where every participant
+ * takes the cheapest allowed second group. Its optimum is a lower bound and subgradient steps on the
+ * multipliers raise it. Feasible assignments are built from every relaxed solution by solving one
+ * layer with the other fixed. Stops after the given iterations, at the deadline or when the assignment
+ * is proven optimal.
+ */
+JointAssignment joint_assignment(const DensePreferences& first, const DensePreferences& second,
+                                 const std::vector<std::pair<uint,uint>>& forbidden, uint iterations,
+                                 std::chrono::steady_clock::time_point deadline
+                                   = std::chrono::steady_clock::time_point::max());
+
+} // namespace assign
@@ -0,0 +1,210 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <map>
+#include <memory>
+#include <algorithm>
+#include "kbest.h"
+#include "moves.h"
+#include "thread_pool.h"
+#include "stats.h"
+
+using namespace assign;
+
+namespace {
+
+typedef GroupMoves::Value Value;
+
+// a partition of the assignments: participants before prefix keep the groups of the solution,
+// participant prefix may not be in any of the banned groups
+struct Node {
+  std::shared_ptr<const std::vector<GroupId>> solution;
+  Value cost = 0;
+  uint prefix = 0;
+  std::vector<GroupId> banned;
+};
+
+// partition whose solution is the parent's with the moves applied
+struct Child {
+  std::shared_ptr<const std::vector<GroupId>> parent;
+  Value cost = 0;
+  uint prefix = 0;
+  std::vector<GroupId> banned;
+  std::vector<std::pair<uint,GroupId>> moves; // participant, new group
+};
+
+class Enumeration {
+public:
+  Enumeration(const DensePreferences& preferences, uint group_size, ThreadPool& pool)
+    : m_Preferences(preferences), m_GroupSize(group_size), m_Pool(pool)
+  {}
+
+  // cheapest alternative of every partition of the node
+  std::vector<Child> partition(const Node& node){
+    const std::vector<GroupId>& solution = *node.solution;
+    uint participants = m_Preferences.size();
+    // the moves of all partitions are a subset of the moves of the node
+    GroupMoves moves(m_Preferences, solution, m_GroupSize);
+    moves.add(node.prefix, node.banned);
+    for(uint participant = node.prefix + 1; participant < participants; ++participant){
+      moves.add(participant);
+    }
+    if(!moves.computePrices(m_Prices)){
+      WARNING("The assignment is not optimal, --k-best may miss cheaper alternatives.");
+    }
+
+    // participant k of a partition leaves its group, everyone after k may follow. blocks walk k
+    // downwards and add the participants behind k one by one
+    uint first = node.prefix;
+    uint blocks = std::max(1u, std::min(m_Pool.size(), participants - first));
+    std::vector<std::vector<Child>> results(blocks);
+    m_Pool.parallel_for(blocks, [&](uint begin, uint end){
+      for(uint block = begin; block < end; ++block){
+        uint low = first + (std::size_t) (participants - first) * block / blocks;
+        uint high = first + (std::size_t) (participants - first) * (block + 1) / blocks;
+        GroupMoves table(m_Preferences, solution, m_GroupSize);
+        for(uint participant = high; participant < participants; ++participant){
+          table.add(participant);
+        }
+        for(uint k = high; k-- > low;){
+          if(k + 1 < high){
+            table.add(k + 1);
+          }
+          Child child;
+          child.banned = k == node.prefix ? node.banned : std::vector<GroupId>();
+          child.banned.push_back(solution[k]);
+          if(reroute(table, solution, k, child)){
+            child.parent = node.solution;
+            child.cost += node.cost;
+            child.prefix = k;
+            results[block].push_back(std::move(child));
+          }
+        }
+      }
+    }, 1);
+    std::vector<Child> result;
+    for(std::vector<Child>& block : results){
+      std::move(block.begin(), block.end(), std::back_inserter(result));
+    }
+    return result;
+  }
+
+private:
+  // cheapest way to move participant k out of its group: into another group and from there along
+  // a chain of moves back into the group k left
+  bool reroute(const GroupMoves& table, const std::vector<GroupId>& solution, uint k, Child& child) const {
+    GroupId left = solution[k];
+    std::vector<Value> chains;
+    std::vector<int> next;
+    table.computeChains(left, m_Prices, chains, next);
+    const Participant::Cost* row = m_Preferences.row(k);
+    Value best = GroupMoves::UNREACHABLE;
+    GroupId target = -1;
+    for(uint group = 0; group < m_Preferences.group_count; ++group){
+      if(chains[group] == GroupMoves::UNREACHABLE
+         || std::find(child.banned.begin(), child.banned.end(), (GroupId) group) != child.banned.end()){
+        continue;
+      }
+      Value cost = row[group] - row[left] + chains[group];
+      if(cost < best){
+        best = cost;
+        target = group;
+      }
+    }
+    if(target < 0){
+      return false;
+    }
+    child.cost = best;
+    child.moves.push_back(std::make_pair(k, target));
+    table.appendChain(target, left, next, GroupMoves::NONE, child.moves);
+    return true;
+  }
+
+  const DensePreferences& m_Preferences;
+  const uint m_GroupSize;
+  ThreadPool& m_Pool;
+  std::vector<Value> m_Prices;
+};
+
+} // namespace
+
+std::vector<RankedAssignment> assign::k_best_assignments(const DensePreferences& preferences, uint k,
+                                                         const SolverOptions& options)
+{
+  std::vector<RankedAssignment> result;
+  if(k == 0){
+    return result;
+  }
+  RankedAssignment best;
+  best.groups = solve_groups(preferences, options);
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    if(best.groups[participant] < 0){ // no groups or no participants, there is nothing to choose
+      result.push_back(best);
+      return result;
+    }
+    best.cost += preferences.row(participant)[best.groups[participant]];
+  }
+  uint group_size = group_capacity(preferences.size(), preferences.group_count);
+  ThreadPool pool(options.threads);
+  Enumeration enumeration(preferences, group_size, pool);
+
+  Node node;
+  node.solution = std::make_shared<const std::vector<GroupId>>(best.groups);
+  node.cost = best.cost;
+  result.push_back(std::move(best));
+  // the open partitions by costs, equal costs in the order they were found. only as many as can
+  // still be reported are kept
+  std::multimap<Value, Child> open;
+  while(result.size() < k){
+    for(Child& child : enumeration.partition(node)){
+      if(open.size() + result.size() >= k && child.cost >= open.rbegin()->first){
+        continue;
+      }
+      open.insert(std::make_pair(child.cost, std::move(child)));
+      if(open.size() + result.size() > k){
+        open.erase(std::prev(open.end()));
+      }
+    }
+    add_counter("kbest.partitions", 1);
+    if(open.empty()) break;
+    Child child = std::move(open.begin()->second);
+    open.erase(open.begin());
+    std::vector<GroupId> groups = *child.parent;
+    for(const std::pair<uint,GroupId>& move : child.moves){
+      groups[move.first] = move.second;
+    }
+    node.solution = std::make_shared<const std::vector<GroupId>>(groups);
+    node.cost = child.cost;
+    node.prefix = child.prefix;
+    node.banned = std::move(child.banned);
+    RankedAssignment ranked;
+    ranked.groups = std::move(groups);
+    ranked.cost = child.cost;
+    result.push_back(std::move(ranked));
+  }
+  return result;
+}
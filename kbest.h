@@ -0,0 +1,51 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+struct RankedAssignment {
+  std::vector<GroupId> groups;
+  long long cost = 0;
+};
+
+/**
+ * The k cheapest different single layer assignments, cheapest first, by Murty's partitioning: the
+ * alternatives of a solution keep the groups of the participants before some participant and move
+ * that one out of its group. The cheapest alternative of every partition is one chain of moves
+ * between the groups, found by Dijkstra on costs reduced by the group prices of the parent, so every
+ * partition costs about groups^2 instead of a full solve. The partitions of a solution are searched
+ * in parallel on options.threads. The first assignment comes from options.solver and has to be optimal.
+ */
+std::vector<RankedAssignment> k_best_assignments(const DensePreferences& preferences, uint k,
+                                                 const SolverOptions& options);
+
+} // namespace assign
@@ -0,0 +1,210 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <utility>
+
+namespace assign {
+
+/**
+ * Shortest augmenting path solver for dense linear assignment problems in the style of
+ * Jonker & Volgenant (LAPJV).
+ *
+ * costs holds a row-major agents x objects matrix with agents <= objects. Returns the assigned
+ * object for every agent. Works for integral and floating point cost types. Potentials and distances
+ * are kept in LapValue<Cost>, which is wider than integral costs so that path lengths do not
+ * overflow: short costs use int, int costs use long long. A short matrix therefore halves the memory
+ * traffic of an int one. The reduction and the inner loops of the shortest path search are written
+ * branch free over contiguous arrays so that the compiler can vectorize them.
+ */
+template<typename Cost>
+std::vector<int> lap_solve(const Cost* costs, unsigned int agents, unsigned int objects);
+
+// type of the potentials and distances. sums of integral costs need a wider type
+template<typename Cost> struct LapValue { typedef Cost type; };
+template<> struct LapValue<signed char> { typedef int type; };
+template<> struct LapValue<short> { typedef int type; };
+template<> struct LapValue<int> { typedef long long type; };
+
+/**
+ * Buffers of lap_solve. Reusing one for several solves keeps their memory, solves which are not
+ * larger than an earlier one do not allocate.
+ */
+template<typename Cost>
+struct LapWorkspace {
+  typedef typename LapValue<Cost>::type Value;
+  std::vector<int> assigned;
+  std::vector<int> owner;
+  std::vector<Value> potentials;
+  std::vector<unsigned int> free_agents;
+  std::vector<Value> distances;
+  std::vector<Value> offsets;
+  std::vector<int> predecessors;
+  std::vector<unsigned int> scanned;
+};
+
+// same as above in the buffers of the workspace. returns workspace.assigned
+template<typename Cost>
+const std::vector<int>& lap_solve(const Cost* costs, unsigned int agents, unsigned int objects,
+                                  LapWorkspace<Cost>& workspace);
+
+namespace lap_detail {
+
+// added to objects which are already scanned. keeps them out of the minimum search and relaxation
+template<typename Cost>
+typename LapValue<Cost>::type blocked(){
+  return std::numeric_limits<typename LapValue<Cost>::type>::max() / 4;
+}
+
+template<typename Cost>
+Cost min_value(const Cost* values, unsigned int size){
+  Cost result = values[0];
+  for(unsigned int i = 1; i < size; ++i){
+    result = values[i] < result ? values[i] : result;
+  }
+  return result;
+}
+
+template<typename Value>
+Value min_value(const Value* values, const Value* offsets, unsigned int size){
+  Value result = values[0] + offsets[0];
+  for(unsigned int i = 1; i < size; ++i){
+    Value value = values[i] + offsets[i];
+    result = value < result ? value : result;
+  }
+  return result;
+}
+
+template<typename Cost, typename Value>
+void relax(Value base, const Cost* costs, const Value* potentials, const Value* offsets, int agent,
+           Value* distances, int* predecessors, unsigned int size)
+{
+  for(unsigned int i = 0; i < size; ++i){
+    Value distance = base + costs[i] - potentials[i] + offsets[i];
+    bool better = distance < distances[i];
+    distances[i] = better ? distance : distances[i];
+    predecessors[i] = better ? agent : predecessors[i];
+  }
+}
+
+} // namespace lap_detail
+
+template<typename Cost>
+std::vector<int> lap_solve(const Cost* costs, unsigned int agents, unsigned int objects){
+  LapWorkspace<Cost> workspace;
+  lap_solve(costs, agents, objects, workspace);
+  return std::move(workspace.assigned);
+}
+
+template<typename Cost>
+const std::vector<int>& lap_solve(const Cost* costs, unsigned int agents, unsigned int objects,
+                                  LapWorkspace<Cost>& workspace)
+{
+  using namespace lap_detail;
+  typedef typename LapWorkspace<Cost>::Value Value;
+  std::vector<int>& assigned = workspace.assigned;
+  std::vector<int>& owner = workspace.owner;
+  std::vector<Value>& potentials = workspace.potentials;
+  assigned.assign(agents, -1);
+  owner.assign(objects, -1);
+  potentials.assign(objects, 0);
+  if(agents == 0 || objects < agents){
+    return assigned;
+  }
+
+  // reduction: agents get their cheapest object when it is still free
+  std::vector<unsigned int>& free_agents = workspace.free_agents;
+  free_agents.clear();
+  for(unsigned int agent = 0; agent < agents; ++agent){
+    const Cost* row = costs + (std::size_t) agent * objects;
+    Cost minimum = min_value(row, objects);
+    for(unsigned int object = 0; object < objects; ++object){
+      if(row[object] == minimum && owner[object] < 0){
+        owner[object] = agent;
+        assigned[agent] = object;
+        break;
+      }
+    }
+    if(assigned[agent] < 0){
+      free_agents.push_back(agent);
+    }
+  }
+
+  // augmentation: dijkstra from every free agent to the nearest free object
+  std::vector<Value>& distances = workspace.distances;
+  std::vector<Value>& offsets = workspace.offsets;
+  std::vector<int>& predecessors = workspace.predecessors;
+  std::vector<unsigned int>& scanned = workspace.scanned;
+  distances.resize(objects);
+  offsets.resize(objects);
+  predecessors.resize(objects);
+  scanned.reserve(objects);
+  for(unsigned int free_agent : free_agents){
+    std::fill(offsets.begin(), offsets.end(), Value(0));
+    std::fill(distances.begin(), distances.end(), std::numeric_limits<Value>::max());
+    relax(Value(0), costs + (std::size_t) free_agent * objects, potentials.data(), offsets.data(),
+          (int) free_agent, distances.data(), predecessors.data(), objects);
+    scanned.clear();
+    int sink = -1;
+    Value sink_distance = 0;
+    while(sink < 0){
+      Value minimum = min_value(distances.data(), offsets.data(), objects);
+      unsigned int object = 0;
+      while(distances[object] + offsets[object] != minimum) { ++object; }
+      offsets[object] = blocked<Cost>();
+      if(owner[object] < 0){
+        sink = object;
+        sink_distance = minimum;
+      } else {
+        scanned.push_back(object);
+        int agent = owner[object];
+        const Cost* row = costs + (std::size_t) agent * objects;
+        Value base = minimum - (row[object] - potentials[object]);
+        relax(base, row, potentials.data(), offsets.data(), agent,
+              distances.data(), predecessors.data(), objects);
+      }
+    }
+    for(unsigned int object : scanned){
+      potentials[object] += distances[object] - sink_distance;
+    }
+    int object = sink;
+    while(true){
+      int agent = predecessors[object];
+      int previous = assigned[agent];
+      owner[object] = agent;
+      assigned[agent] = object;
+      if(agent == (int) free_agent) break;
+      object = previous;
+    }
+  }
+  return assigned;
+}
+
+} // namespace assign
@@ -0,0 +1,161 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <algorithm>
+#include "moves.h"
+
+using namespace assign;
+
+const GroupMoves::Value GroupMoves::UNREACHABLE;
+const uint GroupMoves::NONE;
+
+GroupMoves::GroupMoves(const DensePreferences& preferences, const std::vector<GroupId>& groups, uint group_size)
+  : m_Preferences(preferences), m_Groups(groups), m_GroupSize(group_size), m_GroupCount(preferences.group_count),
+    m_Counts(preferences.group_count, 0), m_Moves((std::size_t) 2 * m_GroupCount * m_GroupCount)
+{
+  for(GroupId group : groups){
+    if(group >= 0){
+      ++m_Counts[group];
+    }
+  }
+}
+
+void GroupMoves::add(uint participant, const std::vector<GroupId>& banned){
+  const Participant::Cost* row = m_Preferences.row(participant);
+  GroupId from = m_Groups[participant];
+  Move* moves = m_Moves.data() + (std::size_t) 2 * from * m_GroupCount;
+  for(uint to = 0; to < m_GroupCount; ++to){
+    Value cost = row[to] - row[from];
+    Move* pair = moves + 2 * to;
+    if((GroupId) to == from || cost >= pair[1].cost
+       || std::find(banned.begin(), banned.end(), (GroupId) to) != banned.end()){
+      continue;
+    }
+    if(cost < pair[0].cost){
+      pair[1] = pair[0];
+      pair[0].cost = cost;
+      pair[0].participant = participant;
+    } else {
+      pair[1].cost = cost;
+      pair[1].participant = participant;
+    }
+  }
+}
+
+const GroupMoves::Move& GroupMoves::move(uint from, uint to, uint excluded) const {
+  const Move* pair = m_Moves.data() + (std::size_t) 2 * (from * m_GroupCount + to);
+  return pair[0].participant == excluded && excluded != NONE ? pair[1] : pair[0];
+}
+
+bool GroupMoves::computePrices(std::vector<Value>& prices) const {
+  uint sink = m_GroupCount;
+  prices.assign(m_GroupCount + 1, 0);
+  bool changed = true;
+  for(uint round = 0; changed && round <= m_GroupCount + 1; ++round){
+    changed = false;
+    for(uint from = 0; from < m_GroupCount; ++from){
+      for(uint to = 0; to < m_GroupCount; ++to){
+        Value cost = move(from, to).cost;
+        if(cost != UNREACHABLE && prices[to] + cost < prices[from]){
+          prices[from] = prices[to] + cost;
+          changed = true;
+        }
+      }
+      if(m_Counts[from] < m_GroupSize && prices[sink] < prices[from]){
+        prices[from] = prices[sink];
+        changed = true;
+      }
+      if(m_Counts[from] > 0 && prices[from] < prices[sink]){
+        prices[sink] = prices[from];
+        changed = true;
+      }
+    }
+  }
+  return !changed;
+}
+
+void GroupMoves::computeChains(GroupId target, const std::vector<Value>& prices, std::vector<Value>& costs,
+                               std::vector<int>& next, uint excluded) const
+{
+  // reverse dijkstra on the reduced costs move + p[to] - p[from]
+  uint sink = m_GroupCount;
+  std::vector<Value> labels(m_GroupCount + 1, UNREACHABLE);
+  std::vector<bool> done(m_GroupCount + 1, false);
+  next.assign(m_GroupCount + 1, -1);
+  labels[target] = 0;
+  auto relax = [&](uint from, uint to, Value cost){
+    Value label = labels[to] + std::max<Value>(0, cost + prices[to] - prices[from]);
+    if(!done[from] && label < labels[from]){
+      labels[from] = label;
+      next[from] = to;
+    }
+  };
+  for(uint step = 0; step <= m_GroupCount; ++step){
+    int current = -1;
+    for(uint node = 0; node <= m_GroupCount; ++node){
+      if(!done[node] && labels[node] != UNREACHABLE && (current < 0 || labels[node] < labels[current])){
+        current = node;
+      }
+    }
+    if(current < 0) break;
+    done[current] = true;
+    if((uint) current == sink){
+      for(uint from = 0; from < m_GroupCount; ++from){
+        if(m_Counts[from] < m_GroupSize){
+          relax(from, sink, 0);
+        }
+      }
+      continue;
+    }
+    for(uint from = 0; from < m_GroupCount; ++from){
+      Value cost = move(from, current, excluded).cost;
+      if(cost != UNREACHABLE){
+        relax(from, current, cost);
+      }
+    }
+    if(m_Counts[current] > 0){
+      relax(sink, current, 0);
+    }
+  }
+  costs.assign(m_GroupCount + 1, UNREACHABLE);
+  for(uint node = 0; node <= m_GroupCount; ++node){
+    if(labels[node] != UNREACHABLE){
+      costs[node] = labels[node] + prices[node] - prices[target];
+    }
+  }
+}
+
+void GroupMoves::appendChain(GroupId group, GroupId target, const std::vector<int>& next, uint excluded,
+                             std::vector<std::pair<uint,GroupId>>& moves) const
+{
+  uint sink = m_GroupCount;
+  for(int node = group; node != target; node = next[node]){
+    if((uint) node != sink && (uint) next[node] != sink){
+      moves.push_back(std::make_pair(move(node, next[node], excluded).participant, (GroupId) next[node]));
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Cheapest and second cheapest move of the added participants between every pair of groups of an
+ * assignment with group_size places per group. With a sink behind the groups, which takes one more
+ * participant from every group with a free place and gives one back to every group with
+ * participants, these moves are the residual graph of the assignment. Every change of an optimal
+ * assignment decomposes into chains of them, so its cheapest changes are shortest paths on costs
+ * reduced by the prices of the groups.
+ */
+class GroupMoves {
+public:
+  typedef long long Value;
+  const static Value UNREACHABLE = std::numeric_limits<Value>::max() / 4;
+  const static uint NONE = std::numeric_limits<uint>::max();
+
+  struct Move {
+    Value cost = UNREACHABLE;
+    uint participant = NONE;
+  };
+
+  GroupMoves(const DensePreferences& preferences, const std::vector<GroupId>& groups, uint group_size);
+
+  // the participant may not move into the banned groups
+  void add(uint participant, const std::vector<GroupId>& banned = std::vector<GroupId>());
+  // cheapest move between the groups by another participant than excluded
+  const Move& move(uint from, uint to, uint excluded = NONE) const;
+
+  uint sink() const { return m_GroupCount; }
+  uint count(uint group) const { return m_Counts[group]; }
+
+  // prices of the groups and the sink with p[from] <= p[to] + move(from, to). false when the moves
+  // have a negative cycle, the assignment was not optimal and changes are only approximated then
+  bool computePrices(std::vector<Value>& prices) const;
+  // costs of the cheapest chains of moves from every group into target and the next group of each
+  // chain, without moves of the excluded participant
+  void computeChains(GroupId target, const std::vector<Value>& prices, std::vector<Value>& costs,
+                     std::vector<int>& next, uint excluded = NONE) const;
+  // appends the moves of the chain from the group into target as participant, new group
+  void appendChain(GroupId group, GroupId target, const std::vector<int>& next, uint excluded,
+                   std::vector<std::pair<uint,GroupId>>& moves) const;
+
+private:
+  const DensePreferences& m_Preferences;
+  const std::vector<GroupId>& m_Groups;
+  const uint m_GroupSize;
+  const uint m_GroupCount;
+  std::vector<uint> m_Counts;
+  std::vector<Move> m_Moves; // cheapest and second cheapest per pair
+};
+
+} // namespace assign
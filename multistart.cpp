@@ -0,0 +1,263 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include "multistart.h"
+#include "thread_pool.h"
+
+using namespace assign;
+
+namespace {
+
+// penalty of the two plain orders, same as the fixed heuristic
+const static Participant::Cost PLAIN_PENALTY = 10000;
+// look-ahead weights are multiples of 1/SCALE of a cost unit
+const static Participant::Cost SCALE = 8;
+// penalties of the randomized starts are the cost range times 2^0 ... 2^PENALTY_STEPS
+const static uint PENALTY_STEPS = 6;
+
+struct Start {
+  std::vector<GroupId> first;
+  std::vector<GroupId> second;
+  long long cost = 0;
+  uint violations = 0;
+  uint unassigned = 0;
+
+  bool betterThan(const Start& other) const {
+    if(unassigned != other.unassigned){
+      return unassigned < other.unassigned;
+    }
+    if(violations != other.violations){
+      return violations < other.violations;
+    }
+    return cost < other.cost;
+  }
+};
+
+Participant::Cost range(const DensePreferences& preferences){
+  if(preferences.cost_count() == 0){
+    return 0;
+  }
+  auto minmax = std::minmax_element(preferences.data(), preferences.data() + preferences.cost_count());
+  return *minmax.second - *minmax.first;
+}
+
+Participant::Cost largest(const DensePreferences& preferences){
+  Participant::Cost result = 0;
+  for(std::size_t index = 0; index < preferences.cost_count(); ++index){
+    Participant::Cost cost = preferences.data()[index];
+    result = std::max(result, cost < 0 ? -cost : cost);
+  }
+  return result;
+}
+
+class MultiStartProblem {
+public:
+  MultiStartProblem(const DensePreferences& first, const DensePreferences& second,
+                    const std::vector<std::pair<uint,uint>>& forbidden, const LayerSolver& solve,
+                    unsigned long seed)
+    : m_First(first), m_Second(second), m_Solve(solve), m_Seed(seed),
+      m_Forbidden((std::size_t) first.group_count * second.group_count, false)
+  {
+    for(const std::pair<uint,uint>& pair : forbidden){
+      if(pair.first < first.group_count && pair.second < second.group_count){
+        m_Forbidden[(std::size_t) pair.first * second.group_count + pair.second] = true;
+      }
+    }
+  }
+
+  Start run(uint index) const {
+    std::seed_seq sequence{ (unsigned int) m_Seed, (unsigned int) (m_Seed >> 16 >> 16), index };
+    std::mt19937 random(sequence);
+    bool swapped = index == 1;
+    std::vector<uint> order(m_First.size());
+    for(uint i = 0; i < order.size(); ++i){
+      order[i] = i;
+    }
+    Participant::Cost weight = 0;
+    uint penalty_step = 0;
+    if(index > 1){
+      swapped = random() % 2 == 1;
+      std::shuffle(order.begin(), order.end(), random);
+      weight = std::uniform_int_distribution<Participant::Cost>(0, SCALE)(random);
+      penalty_step = std::uniform_int_distribution<uint>(0, PENALTY_STEPS)(random);
+    }
+    const DensePreferences& early = swapped ? m_Second : m_First;
+    const DensePreferences& late = swapped ? m_First : m_Second;
+
+    std::vector<GroupId> early_groups = solveEarly(early, late, swapped, order, weight);
+    std::vector<GroupId> late_groups = solveLate(late, early_groups, swapped, order,
+                                                 index > 1 ? randomPenalty(late, penalty_step) : PLAIN_PENALTY);
+    Start result;
+    result.first = std::move(swapped ? late_groups : early_groups);
+    result.second = std::move(swapped ? early_groups : late_groups);
+    evaluate(result);
+    return result;
+  }
+
+private:
+  bool forbidden(GroupId early, GroupId late, bool swapped) const {
+    GroupId first = swapped ? late : early;
+    GroupId second = swapped ? early : late;
+    return m_Forbidden[(std::size_t) first * m_Second.group_count + second];
+  }
+
+  Participant::Cost randomPenalty(const DensePreferences& late, uint step) const {
+    long long penalty = (long long) (range(late) + 1) << step;
+    long long limit = (std::numeric_limits<Participant::Cost>::max() - largest(late)) / 2;
+    return (Participant::Cost) std::max<long long>(1, std::min(penalty, limit));
+  }
+
+  // participants in the given order, costs scaled by SCALE plus weight times the look-ahead
+  std::vector<GroupId> solveEarly(const DensePreferences& early, const DensePreferences& late, bool swapped,
+                                  const std::vector<uint>& order, Participant::Cost weight) const
+  {
+    Participant::Cost late_range = range(late);
+    long long bound = (long long) std::numeric_limits<Participant::Cost>::max() / 2;
+    if((long long) (largest(early) + late_range + 1) * SCALE > bound){
+      weight = 0;
+    }
+    DensePreferences problem;
+    problem.group_count = early.group_count;
+    problem.ids.reserve(order.size());
+    problem.costs.resize(early.cost_count());
+    for(uint k = 0; k < order.size(); ++k){
+      uint participant = order[k];
+      problem.ids.push_back(early.ids[participant]);
+      const Participant::Cost* src = early.row(participant);
+      Participant::Cost* dst = problem.row(k);
+      if(weight == 0){
+        std::copy(src, src + early.group_count, dst);
+        continue;
+      }
+      // how much worse the best allowed group of the other layer is than the best one
+      const Participant::Cost* other = late.row(participant);
+      Participant::Cost best = *std::min_element(other, other + late.group_count);
+      for(uint group = 0; group < early.group_count; ++group){
+        Participant::Cost allowed = best + late_range + 1;
+        for(uint late_group = 0; late_group < late.group_count; ++late_group){
+          if(!forbidden(group, late_group, swapped)){
+            allowed = std::min(allowed, other[late_group]);
+          }
+        }
+        dst[group] = src[group] * SCALE + weight * (allowed - best);
+      }
+    }
+    std::vector<GroupId> groups = m_Solve(problem);
+    std::vector<GroupId> result(order.size(), -1);
+    for(uint k = 0; k < order.size(); ++k){
+      result[order[k]] = groups[k];
+    }
+    return result;
+  }
+
+  std::vector<GroupId> solveLate(const DensePreferences& late, const std::vector<GroupId>& early_groups,
+                                 bool swapped, const std::vector<uint>& order, Participant::Cost penalty) const
+  {
+    DensePreferences problem;
+    problem.group_count = late.group_count;
+    problem.ids.reserve(order.size());
+    problem.costs.resize(late.cost_count());
+    for(uint k = 0; k < order.size(); ++k){
+      uint participant = order[k];
+      problem.ids.push_back(late.ids[participant]);
+      const Participant::Cost* src = late.row(participant);
+      Participant::Cost* dst = problem.row(k);
+      std::copy(src, src + late.group_count, dst);
+      GroupId early = early_groups[participant];
+      if(early < 0){
+        continue;
+      }
+      for(uint group = 0; group < late.group_count; ++group){
+        if(forbidden(early, group, swapped)){
+          dst[group] += penalty;
+        }
+      }
+    }
+    std::vector<GroupId> groups = m_Solve(problem);
+    std::vector<GroupId> result(order.size(), -1);
+    for(uint k = 0; k < order.size(); ++k){
+      result[order[k]] = groups[k];
+    }
+    return result;
+  }
+
+  void evaluate(Start& start) const {
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      GroupId first = start.first[participant];
+      GroupId second = start.second[participant];
+      if(first < 0 || second < 0){
+        ++start.unassigned;
+        continue;
+      }
+      start.cost += (long long) m_First.row(participant)[first] + m_Second.row(participant)[second];
+      if(forbidden(first, second, false)){
+        ++start.violations;
+      }
+    }
+  }
+
+  const DensePreferences& m_First;
+  const DensePreferences& m_Second;
+  const LayerSolver& m_Solve;
+  const unsigned long m_Seed;
+  std::vector<bool> m_Forbidden;
+};
+
+} // namespace
+
+MultiStart assign::multistart_assignment(const DensePreferences& first, const DensePreferences& second,
+                                         const std::vector<std::pair<uint,uint>>& forbidden,
+                                         const LayerSolver& solve, uint starts, unsigned long seed, uint threads)
+{
+  starts = std::max<uint>(starts, 1);
+  MultiStartProblem problem(first, second, forbidden, solve, seed);
+  std::vector<Start> results(starts);
+  ThreadPool pool(std::min<uint>(starts, threads == 0 ? std::thread::hardware_concurrency() : threads));
+  pool.parallel_for(starts, [&](uint begin, uint end){
+    for(uint index = begin; index < end; ++index){
+      results[index] = problem.run(index);
+    }
+  }, 1);
+
+  MultiStart result;
+  for(uint index = 0; index < starts; ++index){
+    result.costs.push_back(results[index].cost);
+    if(results[index].betterThan(results[result.best_start])){
+      result.best_start = index;
+    }
+  }
+  Start& best = results[result.best_start];
+  result.first = std::move(best.first);
+  result.second = std::move(best.second);
+  result.cost = best.cost;
+  result.violations = best.violations;
+  return result;
+}
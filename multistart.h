@@ -0,0 +1,61 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "common.h"
+
+namespace assign {
+
+struct MultiStart {
+  std::vector<GroupId> first;  // group of every participant in the first layer
+  std::vector<GroupId> second; // and in the second, counted from 0
+  long long cost = 0;          // without penalties
+  uint violations = 0;         // forbidden combinations in the result
+  uint best_start = 0;
+  std::vector<long long> costs; // of every start
+};
+
+// solves one layer, returns the group of every participant
+typedef std::function<std::vector<GroupId>(const DensePreferences&)> LayerSolver;
+
+/**
+ * Randomized version of the layer by layer heuristic for exclusive combinations. Every start solves
+ * one layer and then the other one with penalties on the forbidden combinations of the first result.
+ * The starts differ in the layer order, the participant order which breaks ties, the penalty and a
+ * look-ahead weight that makes groups of the first layer more expensive for participants whose
+ * preferred groups of the other layer are forbidden with them. Starts 0 and 1 are the two plain orders.
+ * The starts run in parallel, the result only depends on the seed and is the one with the fewest
+ * violations and then the lowest costs.
+ */
+MultiStart multistart_assignment(const DensePreferences& first, const DensePreferences& second,
+                                 const std::vector<std::pair<uint,uint>>& forbidden, const LayerSolver& solve,
+                                 uint starts, unsigned long seed, uint threads);
+
+} // namespace assign
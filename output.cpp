@@ -0,0 +1,140 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <cstring>
+#include <algorithm>
+#include "output.h"
+
+using namespace assign;
+
+namespace {
+
+const static uint BINARY_VERSION = 1;
+const static uint BINARY_COSTS = 1;
+
+} // namespace
+
+BufferedWriter::BufferedWriter(std::ostream& stream, std::size_t capacity)
+  : m_Stream(stream), m_Buffer(std::max<std::size_t>(capacity, 32))
+{}
+
+BufferedWriter::~BufferedWriter(){
+  flush();
+}
+
+void BufferedWriter::write(const char* data, std::size_t size){
+  if(m_Size + size > m_Buffer.size()){
+    flush();
+    if(size > m_Buffer.size()){
+      m_Stream.write(data, size);
+      return;
+    }
+  }
+  std::memcpy(m_Buffer.data() + m_Size, data, size);
+  m_Size += size;
+}
+
+void BufferedWriter::write(char character){
+  if(m_Size == m_Buffer.size()){
+    flush();
+  }
+  m_Buffer[m_Size++] = character;
+}
+
+void BufferedWriter::writeInteger(long long value){
+  if(m_Size + 24 > m_Buffer.size()){
+    flush();
+  }
+  char* out = m_Buffer.data() + m_Size;
+  unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long) value : value;
+  if(value < 0){
+    *out++ = '-';
+  }
+  char digits[20];
+  uint count = 0;
+  do {
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while(magnitude > 0);
+  while(count > 0){
+    *out++ = digits[--count];
+  }
+  m_Size = out - m_Buffer.data();
+}
+
+void BufferedWriter::writeInt32(int value){
+  if(m_Size + 4 > m_Buffer.size()){
+    flush();
+  }
+  unsigned int bits = (unsigned int) value;
+  for(uint byte = 0; byte < 4; ++byte){
+    m_Buffer[m_Size++] = (char) ((bits >> (8 * byte)) & 0xff);
+  }
+}
+
+void BufferedWriter::flush(){
+  if(m_Size > 0){
+    m_Stream.write(m_Buffer.data(), m_Size);
+    m_Size = 0;
+  }
+  m_Stream.flush();
+}
+
+void assign::write_assignments_csv(const AssignmentResult& result, bool print_costs, std::ostream& stream){
+  BufferedWriter writer(stream);
+  for(uint participant = 0; participant < result.size(); ++participant){
+    writer.write(result.id(participant));
+    for(uint layer = 0; layer < result.layers; ++layer){
+      writer.write(',');
+      writer.writeInteger(result.group(participant, layer));
+    }
+    if(print_costs){
+      for(uint layer = 0; layer < result.layers; ++layer){
+        writer.write(',');
+        writer.writeInteger(result.cost(participant, layer));
+      }
+    }
+    writer.write('\n');
+  }
+}
+
+void assign::write_assignments_binary(const AssignmentResult& result, bool print_costs, std::ostream& stream){
+  BufferedWriter writer(stream);
+  writer.write("ASGN", 4);
+  writer.writeInt32(BINARY_VERSION);
+  writer.writeInt32(result.size());
+  writer.writeInt32(result.layers);
+  writer.writeInt32(print_costs ? BINARY_COSTS : 0);
+  for(GroupId group : result.groups){
+    writer.writeInt32(group);
+  }
+  if(print_costs){
+    for(Participant::Cost cost : result.costs){
+      writer.writeInt32(cost);
+    }
+  }
+}
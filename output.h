@@ -0,0 +1,73 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Collects output in a large buffer and formats integers itself. Writes to the stream when the
+ * buffer is full and on flush or destruction.
+ */
+class BufferedWriter {
+public:
+  explicit BufferedWriter(std::ostream& stream, std::size_t capacity = 1 << 16);
+  ~BufferedWriter();
+
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  void write(const char* data, std::size_t size);
+  void write(const std::string& text) { write(text.data(), text.size()); }
+  void write(char character);
+  void writeInteger(long long value);
+  void writeInt32(int value); // four bytes little endian
+  void flush();
+
+private:
+  std::ostream& m_Stream;
+  std::vector<char> m_Buffer;
+  std::size_t m_Size = 0;
+};
+
+// same format as print_assignments_csv
+void write_assignments_csv(const AssignmentResult& result, bool print_costs, std::ostream& stream = std::cout);
+
+/**
+ * Binary result for other tools, all numbers as little endian 32 bit integers:
+ * "ASGN", version (1), participants, layers, flags (1: costs follow), the groups of every participant
+ * and layer, participant major, and with the costs flag the costs in the same order. Participants are
+ * in input order, their ids are not written. Unassigned participants have group and costs -1.
+ */
+void write_assignments_binary(const AssignmentResult& result, bool print_costs, std::ostream& stream = std::cout);
+
+} // namespace assign
@@ -0,0 +1,332 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include "refine.h"
+#include "thread_pool.h"
+
+using namespace assign;
+
+namespace {
+
+typedef long long Distance;
+
+// swaps of both groups keep partner lists for all pairs of combinations, skip them above
+const static uint MAX_COMBINATIONS = 256;
+
+enum class Kind { NONE, MOVE_FIRST, MOVE_SECOND, SWAP_FIRST, SWAP_SECOND, SWAP_BOTH };
+
+// a participant that can take the place of another one, delta is its cost change
+struct Partner {
+  Distance delta;
+  uint participant;
+
+  bool operator<(const Partner& other) const {
+    return (delta != other.delta) ? delta < other.delta : participant < other.participant;
+  }
+};
+
+struct Candidate {
+  Distance gain = 0;
+  Distance base = 0; // gain without the cost change of the partner
+  Kind kind = Kind::NONE;
+  GroupId first = -1;  // target groups of the participant
+  GroupId second = -1;
+  uint partners = 0;   // partner list of swaps
+  uint participant = 0;
+
+  bool operator<(const Candidate& other) const {
+    return (gain != other.gain) ? gain > other.gain : participant < other.participant;
+  }
+};
+
+class LocalSearch {
+public:
+  LocalSearch(const DensePreferences& first, const DensePreferences& second,
+              const std::vector<std::pair<uint,uint>>& forbidden,
+              std::vector<GroupId>& first_groups, std::vector<GroupId>& second_groups, ThreadPool& pool)
+    : m_First(first), m_Second(second), m_S(first.group_count), m_T(second.group_count),
+      m_Combinations(m_S * m_T <= MAX_COMBINATIONS ? m_S * m_T : 0),
+      m_Forbidden((std::size_t) m_S * m_T, false), m_FirstGroups(first_groups), m_SecondGroups(second_groups),
+      m_FirstCapacity(group_capacity(first.size(), m_S)), m_SecondCapacity(group_capacity(first.size(), m_T)),
+      m_FirstMembers(m_S, 0), m_SecondMembers(m_T, 0),
+      m_Partners(m_S * m_S + m_T * m_T + m_Combinations * m_Combinations), m_Cursors(m_Partners.size(), 0),
+      m_Candidates(first.size()), m_Touched(first.size(), false), m_Pool(pool)
+  {
+    for(const std::pair<uint,uint>& pair : forbidden){
+      if(pair.first < m_S && pair.second < m_T){
+        m_Forbidden[(std::size_t) pair.first * m_T + pair.second] = true;
+      }
+    }
+    // a forbidden combination is more expensive than any change of the costs
+    Distance range = 1;
+    for(const DensePreferences* layer : { &first, &second }){
+      if(layer->cost_count() > 0){
+        auto minmax = std::minmax_element(layer->data(), layer->data() + layer->cost_count());
+        range += Distance(*minmax.second) - *minmax.first;
+      }
+    }
+    m_Penalty = range * (first.size() + 1);
+    for(uint participant = 0; participant < first.size(); ++participant){
+      ++m_FirstMembers[m_FirstGroups[participant]];
+      ++m_SecondMembers[m_SecondGroups[participant]];
+    }
+  }
+
+  bool forbidden(GroupId first, GroupId second) const {
+    return m_Forbidden[(std::size_t) first * m_T + second];
+  }
+
+  Distance cost(uint participant, GroupId first, GroupId second) const {
+    return (Distance) m_First.row(participant)[first] + m_Second.row(participant)[second];
+  }
+
+  Distance value(uint participant, GroupId first, GroupId second) const {
+    return cost(participant, first, second) + (forbidden(first, second) ? m_Penalty : 0);
+  }
+
+  Distance cost() const {
+    Distance result = 0;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      result += cost(participant, m_FirstGroups[participant], m_SecondGroups[participant]);
+    }
+    return result;
+  }
+
+  uint violations() const {
+    uint result = 0;
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      result += forbidden(m_FirstGroups[participant], m_SecondGroups[participant]);
+    }
+    return result;
+  }
+
+  // returns whether anything changed
+  bool round(){
+    buildPartners();
+    m_Pool.parallel_for(m_First.size(), [this](uint begin, uint end){
+      for(uint participant = begin; participant < end; ++participant){
+        m_Candidates[participant] = bestCandidate(participant);
+      }
+    });
+    std::vector<Candidate> improving;
+    for(const Candidate& candidate : m_Candidates){
+      if(candidate.gain > 0){
+        improving.push_back(candidate);
+      }
+    }
+    std::sort(improving.begin(), improving.end());
+    std::fill(m_Touched.begin(), m_Touched.end(), false);
+    std::fill(m_Cursors.begin(), m_Cursors.end(), 0);
+    bool changed = false;
+    for(const Candidate& candidate : improving){
+      changed = apply(candidate) || changed;
+    }
+    return changed;
+  }
+
+private:
+  uint firstBucket(GroupId from, GroupId to) const { return from * m_S + to; }
+  uint secondBucket(GroupId from, GroupId to) const { return m_S * m_S + from * m_T + to; }
+  uint bothBucket(GroupId from_first, GroupId from_second, GroupId to_first, GroupId to_second) const {
+    return m_S * m_S + m_T * m_T + (from_first * m_T + from_second) * m_Combinations + to_first * m_T + to_second;
+  }
+
+  // participants of every group sorted by their cost change when taking a place in another group
+  void buildPartners(){
+    std::vector<std::vector<uint>> first_members(m_S), second_members(m_T), both_members(m_S * m_T);
+    for(uint participant = 0; participant < m_First.size(); ++participant){
+      first_members[m_FirstGroups[participant]].push_back(participant);
+      second_members[m_SecondGroups[participant]].push_back(participant);
+      both_members[m_FirstGroups[participant] * m_T + m_SecondGroups[participant]].push_back(participant);
+    }
+    m_Pool.parallel_for(m_Partners.size(), [&](uint begin, uint end){
+      for(uint bucket = begin; bucket < end; ++bucket){
+        std::vector<Partner>& partners = m_Partners[bucket];
+        partners.clear();
+        if(bucket < m_S * m_S){
+          GroupId from = bucket / m_S, to = bucket % m_S;
+          if(from == to) continue;
+          for(uint q : first_members[from]){
+            Partner partner = { value(q, to, m_SecondGroups[q]) - value(q, from, m_SecondGroups[q]), q };
+            partners.push_back(partner);
+          }
+        } else if(bucket < m_S * m_S + m_T * m_T){
+          uint index = bucket - m_S * m_S;
+          GroupId from = index / m_T, to = index % m_T;
+          if(from == to) continue;
+          for(uint q : second_members[from]){
+            Partner partner = { value(q, m_FirstGroups[q], to) - value(q, m_FirstGroups[q], from), q };
+            partners.push_back(partner);
+          }
+        } else {
+          uint index = bucket - m_S * m_S - m_T * m_T;
+          uint from = index / m_Combinations, to = index % m_Combinations;
+          GroupId from_first = from / m_T, from_second = from % m_T, to_first = to / m_T, to_second = to % m_T;
+          if(from_first == to_first || from_second == to_second) continue;
+          for(uint q : both_members[from]){
+            Partner partner = { value(q, to_first, to_second) - value(q, from_first, from_second), q };
+            partners.push_back(partner);
+          }
+        }
+        std::sort(partners.begin(), partners.end());
+      }
+    });
+  }
+
+  void consider(Candidate& best, Kind kind, Distance base, GroupId first, GroupId second, uint partners) const {
+    Distance gain = base;
+    if(kind == Kind::SWAP_FIRST || kind == Kind::SWAP_SECOND || kind == Kind::SWAP_BOTH){
+      if(m_Partners[partners].empty()) return;
+      gain -= m_Partners[partners].front().delta;
+    }
+    if(gain > best.gain){
+      best.gain = gain;
+      best.base = base;
+      best.kind = kind;
+      best.first = first;
+      best.second = second;
+      best.partners = partners;
+    }
+  }
+
+  Candidate bestCandidate(uint participant) const {
+    Candidate best;
+    best.participant = participant;
+    GroupId first = m_FirstGroups[participant], second = m_SecondGroups[participant];
+    Distance current = value(participant, first, second);
+    for(GroupId other = 0; other < (GroupId) m_S; ++other){
+      if(other == first) continue;
+      Distance base = current - value(participant, other, second);
+      if(m_FirstMembers[other] < m_FirstCapacity){
+        consider(best, Kind::MOVE_FIRST, base, other, second, 0);
+      }
+      consider(best, Kind::SWAP_FIRST, base, other, second, firstBucket(other, first));
+    }
+    for(GroupId other = 0; other < (GroupId) m_T; ++other){
+      if(other == second) continue;
+      Distance base = current - value(participant, first, other);
+      if(m_SecondMembers[other] < m_SecondCapacity){
+        consider(best, Kind::MOVE_SECOND, base, first, other, 0);
+      }
+      consider(best, Kind::SWAP_SECOND, base, first, other, secondBucket(other, second));
+    }
+    for(GroupId other_first = 0; m_Combinations > 0 && other_first < (GroupId) m_S; ++other_first){
+      for(GroupId other_second = 0; other_second < (GroupId) m_T; ++other_second){
+        if(other_first == first || other_second == second) continue;
+        consider(best, Kind::SWAP_BOTH, current - value(participant, other_first, other_second),
+                 other_first, other_second, bothBucket(other_first, other_second, first, second));
+      }
+    }
+    return best;
+  }
+
+  void place(uint participant, GroupId first, GroupId second){
+    --m_FirstMembers[m_FirstGroups[participant]];
+    --m_SecondMembers[m_SecondGroups[participant]];
+    m_FirstGroups[participant] = first;
+    m_SecondGroups[participant] = second;
+    ++m_FirstMembers[first];
+    ++m_SecondMembers[second];
+    m_Touched[participant] = true;
+  }
+
+  // applies a candidate unless its participants changed in this round already
+  bool apply(const Candidate& candidate){
+    uint participant = candidate.participant;
+    if(m_Touched[participant]) return false;
+    GroupId first = m_FirstGroups[participant], second = m_SecondGroups[participant];
+    if(candidate.kind == Kind::MOVE_FIRST || candidate.kind == Kind::MOVE_SECOND){
+      if(m_FirstMembers[candidate.first] + (candidate.first != first) > m_FirstCapacity ||
+         m_SecondMembers[candidate.second] + (candidate.second != second) > m_SecondCapacity){
+        return false;
+      }
+      place(participant, candidate.first, candidate.second);
+      return true;
+    }
+    // the best partner may have moved, take the best one left
+    const std::vector<Partner>& partners = m_Partners[candidate.partners];
+    uint& cursor = m_Cursors[candidate.partners];
+    while(cursor < partners.size() && m_Touched[partners[cursor].participant]) { ++cursor; }
+    if(cursor == partners.size() || candidate.base - partners[cursor].delta <= 0){
+      return false;
+    }
+    uint partner = partners[cursor].participant;
+    place(partner, candidate.kind == Kind::SWAP_SECOND ? m_FirstGroups[partner] : first,
+           candidate.kind == Kind::SWAP_FIRST ? m_SecondGroups[partner] : second);
+    place(participant, candidate.first, candidate.second);
+    return true;
+  }
+
+  const DensePreferences& m_First;
+  const DensePreferences& m_Second;
+  const uint m_S; // groups per layer
+  const uint m_T;
+  const uint m_Combinations; // 0 without swaps of both groups
+  std::vector<char> m_Forbidden;
+  Distance m_Penalty;
+  std::vector<GroupId>& m_FirstGroups;
+  std::vector<GroupId>& m_SecondGroups;
+  const uint m_FirstCapacity;
+  const uint m_SecondCapacity;
+  std::vector<uint> m_FirstMembers;
+  std::vector<uint> m_SecondMembers;
+  std::vector<std::vector<Partner>> m_Partners;
+  std::vector<uint> m_Cursors;
+  std::vector<Candidate> m_Candidates;
+  std::vector<char> m_Touched;
+  ThreadPool& m_Pool;
+};
+
+} // namespace
+
+Refinement assign::refine_assignment(const DensePreferences& first, const DensePreferences& second,
+                                     const std::vector<std::pair<uint,uint>>& forbidden,
+                                     std::vector<GroupId>& first_groups, std::vector<GroupId>& second_groups,
+                                     uint milliseconds, uint threads)
+{
+  Refinement result;
+  if(first.size() == 0 || first.group_count == 0 || second.group_count == 0){
+    return result;
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+  ThreadPool pool(threads);
+  LocalSearch search(first, second, forbidden, first_groups, second_groups, pool);
+  result.cost_before = search.cost();
+  result.violations_before = search.violations();
+  while(std::chrono::steady_clock::now() < deadline){
+    ++result.rounds;
+    if(!search.round()){
+      break;
+    }
+  }
+  result.cost_after = search.cost();
+  result.violations_after = search.violations();
+  return result;
+}
@@ -0,0 +1,55 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+
+namespace assign {
+
+struct Refinement {
+  long long cost_before = 0;
+  long long cost_after = 0;
+  uint violations_before = 0; // forbidden combinations
+  uint violations_after = 0;
+  uint rounds = 0;
+};
+
+/**
+ * Local search on an assignment of every participant to one group of each layer. Improves it with
+ * moves to groups with free places, swaps of two participants in one layer and swaps of both groups
+ * at once, which also clears or avoids forbidden combinations. The best move of every participant
+ * is searched in parallel, the moves of disjoint participants are applied together. Stops at a
+ * local minimum or after the given milliseconds.
+ */
+Refinement refine_assignment(const DensePreferences& first, const DensePreferences& second,
+                             const std::vector<std::pair<uint,uint>>& forbidden,
+                             std::vector<GroupId>& first_groups, std::vector<GroupId>& second_groups,
+                             uint milliseconds, uint threads);
+
+} // namespace assign
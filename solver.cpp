@@ -0,0 +1,251 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <limits>
+#include <algorithm>
+#include "solver.h"
+#include "flow.h"
+#include "lap.h"
+#include "auction.h"
+#include "approx.h"
+#include "stats.h"
+#include "munkres.h"
+#include "matrix.h"
+
+using namespace assign;
+
+namespace {
+
+// preferences for the solvers which work on them. int32_t costs are used in place
+template<typename Cost>
+DensePreferences toPreferences(const Cost* costs, uint participants, uint group_count){
+  DensePreferences result;
+  result.ids.resize(participants);
+  result.group_count = group_count;
+  result.costs.assign(costs, costs + (std::size_t) participants * group_count);
+  return result;
+}
+
+template<>
+DensePreferences toPreferences(const Participant::Cost* costs, uint participants, uint group_count){
+  DensePreferences result;
+  result.ids.resize(participants);
+  result.group_count = group_count;
+  result.mapped = costs;
+  return result;
+}
+
+template<typename Cost>
+class FlowSolver : public GroupSolver<Cost> {
+public:
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    StatsPhase phase("flow");
+    return flow_assignment(toPreferences(costs, participants, group_count),
+                           group_capacity(participants, group_count));
+  }
+};
+
+template<typename Cost>
+class AuctionSolver : public GroupSolver<Cost> {
+public:
+  explicit AuctionSolver(const SolverOptions& options) : m_Options(options) {}
+
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    StatsPhase phase("auction");
+    return auction_assignment(toPreferences(costs, participants, group_count),
+                              group_capacity(participants, group_count), m_Options.threads);
+  }
+
+private:
+  const SolverOptions m_Options;
+};
+
+// best assignment at the deadline of the options, reports every improvement to their progress
+template<typename Cost>
+class AnytimeSolver : public GroupSolver<Cost> {
+public:
+  explicit AnytimeSolver(const SolverOptions& options) : m_Options(options) {}
+
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    StatsPhase phase("auction");
+    auto start = std::chrono::steady_clock::now();
+    AuctionProgress progress;
+    if(m_Options.progress){
+      progress = [this](const AuctionResult& result){
+        m_Options.progress(result.groups, result.cost, result.lower_bound);
+      };
+    }
+    AuctionResult result = auction_assignment(toPreferences(costs, participants, group_count),
+                                              group_capacity(participants, group_count), m_Options.threads,
+                                              m_Options.deadline, progress);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if(result.cost > result.lower_bound){
+      WARNING("Time limit reached with costs " << result.cost << ", lower bound " << result.lower_bound
+              << " (gap " << result.cost - result.lower_bound << ") after " << elapsed.count() << " ms.");
+    }
+    return result.groups;
+  }
+
+private:
+  const SolverOptions m_Options;
+};
+
+template<typename Cost>
+class ApproxSolver : public GroupSolver<Cost> {
+public:
+  explicit ApproxSolver(const SolverOptions& options) : m_Options(options) {}
+
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    StatsPhase phase("approx");
+    ApproxResult result = approx_assignment(toPreferences(costs, participants, group_count),
+                                            group_capacity(participants, group_count), m_Options.threads);
+    WARNING("Approximate assignment with costs " << result.cost << ", lower bound " << result.lower_bound
+            << " (gap " << result.cost - result.lower_bound << ") after " << result.rounds << " rounds.");
+    return result.groups;
+  }
+
+private:
+  const SolverOptions m_Options;
+};
+
+// participants x slots matrix in Cost. slots are the groups replicated up to their capacity
+template<typename Cost>
+class LapjvSolver : public GroupSolver<Cost> {
+public:
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    uint slots = group_count * group_capacity(participants, group_count);
+    set_statistic("matrix.columns", slots);
+    std::vector<Cost> matrix((std::size_t) participants * slots);
+    {
+      StatsPhase phase("lapjv.costs");
+      for(uint participant = 0; participant < participants; ++participant){
+        const Cost* src = costs + (std::size_t) participant * group_count;
+        Cost* row = matrix.data() + (std::size_t) participant * slots;
+        for(uint slot = 0; slot < slots; slot += group_count){
+          std::copy(src, src + group_count, row + slot);
+        }
+      }
+    }
+    StatsPhase phase("lapjv");
+    LapWorkspace<Cost> workspace;
+    std::vector<GroupId> groups = lap_solve(matrix.data(), participants, slots, workspace);
+    add_counter("lapjv.augmentations", workspace.free_agents.size());
+    for(GroupId& group : groups){
+      if(group >= 0) { group %= group_count; }
+    }
+    return groups;
+  }
+};
+
+// slots x participants matrix of doubles, munkres marks the assignment with zeros in it
+template<typename Cost>
+class MunkresSolver : public GroupSolver<Cost> {
+public:
+  std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) override {
+    uint rows = group_count * group_capacity(participants, group_count);
+    Matrix<double> solution(rows, participants);
+    {
+      StatsPhase phase("munkres.matrix");
+      for(uint row = 0; row < rows; ++row){
+        for(uint column = 0; column < participants; ++column){
+          solution(row, column) = costs[(std::size_t) column * group_count + row % group_count]; // transposing
+        }
+      }
+    }
+    set_statistic("matrix.columns", solution.columns());
+    {
+      StatsPhase phase("munkres");
+      Munkres munkres;
+      munkres.solve(solution);
+    }
+    std::vector<GroupId> result;
+    result.reserve(participants);
+    for(uint column = 0; column < participants; ++column){
+      std::vector<int> assigned;
+      for(uint row = 0; row < rows; ++row){
+        if(solution(row, column) == 0){
+          assigned.push_back(row);
+        }
+      }
+      if(assigned.size() == 0){
+        result.push_back(-1);
+      } else {
+        if(assigned.size() > 1){
+          WARNING("Participant " << column << " was assigned to multiple groups: " << to_string(assigned)
+                  << " will use the first.");
+        }
+        result.push_back(assigned.front() % group_count);
+      }
+    }
+    return result;
+  }
+};
+
+template<typename Cost>
+bool fits(const DensePreferences& preferences){
+  const Participant::Cost* begin = preferences.data();
+  const Participant::Cost* end = begin + preferences.cost_count();
+  if(begin == end) return true;
+  auto range = std::minmax_element(begin, end);
+  return *range.first >= std::numeric_limits<Cost>::min() && *range.second <= std::numeric_limits<Cost>::max();
+}
+
+} // namespace
+
+template<typename Cost>
+std::unique_ptr<GroupSolver<Cost>> assign::create_group_solver(const SolverOptions& options){
+  if(options.time_limit_ms > 0){
+    return std::unique_ptr<GroupSolver<Cost>>(new AnytimeSolver<Cost>(options));
+  }
+  switch(options.solver){
+  case Solver::FLOW:
+    return std::unique_ptr<GroupSolver<Cost>>(new FlowSolver<Cost>());
+  case Solver::AUCTION:
+    return std::unique_ptr<GroupSolver<Cost>>(new AuctionSolver<Cost>(options));
+  case Solver::LAPJV:
+    return std::unique_ptr<GroupSolver<Cost>>(new LapjvSolver<Cost>());
+  case Solver::APPROX:
+    return std::unique_ptr<GroupSolver<Cost>>(new ApproxSolver<Cost>(options));
+  case Solver::MUNKRES:
+    break;
+  }
+  return std::unique_ptr<GroupSolver<Cost>>(new MunkresSolver<Cost>());
+}
+
+template std::unique_ptr<GroupSolver<std::int16_t>> assign::create_group_solver(const SolverOptions& options);
+template std::unique_ptr<GroupSolver<std::int32_t>> assign::create_group_solver(const SolverOptions& options);
+
+std::vector<GroupId> assign::solve_narrowest(const DensePreferences& preferences, const SolverOptions& options){
+  // only lapjv keeps its matrix in the cost type, the others would just pay for the copy
+  if(options.solver == Solver::LAPJV && options.time_limit_ms == 0 && fits<std::int16_t>(preferences)){
+    std::vector<std::int16_t> costs(preferences.data(), preferences.data() + preferences.cost_count());
+    return create_group_solver<std::int16_t>(options)->solve(costs.data(), preferences.size(),
+                                                             preferences.group_count);
+  }
+  return create_group_solver<Participant::Cost>(options)->solve(preferences.data(), preferences.size(),
+                                                                preferences.group_count);
+}
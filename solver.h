@@ -0,0 +1,60 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "common.h"
+
+namespace assign {
+
+/**
+ * Single layer solver on a row-major participants x groups block of costs. Every group takes up to
+ * ceil(participants / groups) participants. The matrix solvers build their participants x slots
+ * matrix in Cost, a block of int16_t costs halves the memory traffic of lapjv compared to int32_t.
+ * Munkres always works on doubles, flow, auction and approx on the int32_t preferences.
+ */
+template<typename Cost>
+class GroupSolver {
+public:
+  virtual ~GroupSolver() {}
+
+  // group of every participant or -1 when it could not be assigned
+  virtual std::vector<GroupId> solve(const Cost* costs, uint participants, uint group_count) = 0;
+};
+
+// the backend of options.solver, or the anytime auction when options.time_limit_ms is set.
+// available for int16_t and int32_t costs
+template<typename Cost>
+std::unique_ptr<GroupSolver<Cost>> create_group_solver(const SolverOptions& options);
+
+// solves the preferences in the narrowest cost type which holds them and the solver can use
+std::vector<GroupId> solve_narrowest(const DensePreferences& preferences, const SolverOptions& options);
+
+} // namespace assign
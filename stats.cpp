@@ -0,0 +1,231 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <ctime>
+#include <sys/resource.h>
+#include "stats.h"
+#include "common.h"
+
+using namespace assign;
+
+namespace {
+
+struct PhaseRecord {
+  const char* name;
+  uint thread;
+  double start_us;
+  double wall_us;
+  double cpu_us;
+};
+
+struct Collector {
+  std::atomic<bool> enabled{ false };
+  std::mutex mutex;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<PhaseRecord> phases;
+  std::map<std::thread::id, uint> threads;
+  std::map<std::string, long long> counters;
+  std::map<std::string, double> statistics;
+  std::map<std::string, std::vector<double>> lists;
+};
+
+Collector& collector(){
+  static Collector instance;
+  return instance;
+}
+
+double thread_cpu_us(){
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec * 1e6 + time.tv_nsec / 1e3;
+}
+
+double microseconds(std::chrono::steady_clock::duration duration){
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void write_string(std::ostream& stream, const std::string& text){
+  stream << '"';
+  for(char c : text){
+    if(c == '"' || c == '\\') stream << '\\';
+    stream << c;
+  }
+  stream << '"';
+}
+
+void write_stream(const std::string& path, void (*write)(std::ostream&)){
+  if(path.empty()){
+    return;
+  }
+  if(path == "stderr"){
+    write(std::cerr);
+    return;
+  }
+  std::ofstream file(path.c_str());
+  if(!file){
+    ERROR(1,"Could not open statistics file '" << path << "'.");
+  }
+  write(file);
+}
+
+} // namespace
+
+void assign::enable_stats(){
+  collector().enabled = true;
+}
+
+bool assign::stats_enabled(){
+  return collector().enabled;
+}
+
+void assign::add_counter(const std::string& name, long long value){
+  if(!stats_enabled()) return;
+  std::lock_guard<std::mutex> lock(collector().mutex);
+  collector().counters[name] += value;
+}
+
+void assign::set_statistic(const std::string& name, double value){
+  if(!stats_enabled()) return;
+  std::lock_guard<std::mutex> lock(collector().mutex);
+  collector().statistics[name] = value;
+}
+
+void assign::append_statistic(const std::string& name, double value){
+  if(!stats_enabled()) return;
+  std::lock_guard<std::mutex> lock(collector().mutex);
+  collector().lists[name].push_back(value);
+}
+
+StatsPhase::StatsPhase(const char* name)
+  : m_Name(name), m_Enabled(stats_enabled())
+{
+  if(m_Enabled){
+    m_Start = std::chrono::steady_clock::now();
+    m_CpuStart = thread_cpu_us();
+  }
+}
+
+StatsPhase::~StatsPhase(){
+  if(!m_Enabled) return;
+  double cpu = thread_cpu_us() - m_CpuStart;
+  auto end = std::chrono::steady_clock::now();
+  Collector& stats = collector();
+  std::lock_guard<std::mutex> lock(stats.mutex);
+  auto thread = stats.threads.insert(std::make_pair(std::this_thread::get_id(), (uint) stats.threads.size()));
+  PhaseRecord record;
+  record.name = m_Name;
+  record.thread = thread.first->second;
+  record.start_us = microseconds(m_Start - stats.start);
+  record.wall_us = microseconds(end - m_Start);
+  record.cpu_us = cpu;
+  stats.phases.push_back(record);
+}
+
+void assign::write_stats_json(std::ostream& stream){
+  Collector& stats = collector();
+  std::lock_guard<std::mutex> lock(stats.mutex);
+  std::streamsize precision = stream.precision(12); // costs of large instances stay exact
+  struct Sum { uint count = 0; double wall_us = 0; double cpu_us = 0; };
+  std::vector<std::string> order; // first appearance
+  std::map<std::string, Sum> sums;
+  for(const PhaseRecord& phase : stats.phases){
+    if(sums.count(phase.name) == 0) order.push_back(phase.name);
+    Sum& sum = sums[phase.name];
+    ++sum.count;
+    sum.wall_us += phase.wall_us;
+    sum.cpu_us += phase.cpu_us;
+  }
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double cpu_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3
+                  + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+
+  stream << "{\n  \"wall_ms\": " << microseconds(std::chrono::steady_clock::now() - stats.start) / 1e3
+         << ",\n  \"cpu_ms\": " << cpu_ms
+         << ",\n  \"peak_rss_kb\": " << usage.ru_maxrss
+         << ",\n  \"phases\": [";
+  for(uint i = 0; i < order.size(); ++i){
+    const Sum& sum = sums[order[i]];
+    stream << (i == 0 ? "\n    " : ",\n    ") << "{ \"name\": ";
+    write_string(stream, order[i]);
+    stream << ", \"count\": " << sum.count << ", \"wall_ms\": " << sum.wall_us / 1e3
+           << ", \"cpu_ms\": " << sum.cpu_us / 1e3 << " }";
+  }
+  stream << (order.empty() ? "]" : "\n  ]") << ",\n  \"counters\": {";
+  bool first = true;
+  for(const auto& counter : stats.counters){
+    stream << (first ? "\n    " : ",\n    ");
+    write_string(stream, counter.first);
+    stream << ": " << counter.second;
+    first = false;
+  }
+  stream << (first ? "}" : "\n  }") << ",\n  \"values\": {";
+  first = true;
+  for(const auto& statistic : stats.statistics){
+    stream << (first ? "\n    " : ",\n    ");
+    write_string(stream, statistic.first);
+    stream << ": " << statistic.second;
+    first = false;
+  }
+  for(const auto& list : stats.lists){
+    stream << (first ? "\n    " : ",\n    ");
+    write_string(stream, list.first);
+    stream << ": [";
+    for(uint i = 0; i < list.second.size(); ++i){
+      stream << (i == 0 ? " " : ", ") << list.second[i];
+    }
+    stream << " ]";
+    first = false;
+  }
+  stream << (first ? "}" : "\n  }") << "\n}" << std::endl;
+  stream.precision(precision);
+}
+
+void assign::write_stats_trace(std::ostream& stream){
+  Collector& stats = collector();
+  std::lock_guard<std::mutex> lock(stats.mutex);
+  stream << "{ \"traceEvents\": [";
+  for(uint i = 0; i < stats.phases.size(); ++i){
+    const PhaseRecord& phase = stats.phases[i];
+    stream << (i == 0 ? "\n  " : ",\n  ") << "{ \"name\": ";
+    write_string(stream, phase.name);
+    stream << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << phase.thread << ", \"ts\": " << phase.start_us
+           << ", \"dur\": " << phase.wall_us << ", \"args\": { \"cpu_us\": " << phase.cpu_us << " } }";
+  }
+  stream << "\n], \"displayTimeUnit\": \"ms\" }" << std::endl;
+}
+
+void assign::write_stats(const std::string& stats_path, const std::string& trace_path){
+  write_stream(stats_path, write_stats_json);
+  write_stream(trace_path, write_stats_trace);
+}
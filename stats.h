@@ -0,0 +1,74 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <chrono>
+
+namespace assign {
+
+/**
+ * Run statistics for --stats and --trace. Everything is a no-op until enable_stats was called, the
+ * functions may be used from any thread.
+ *
+ * Phases are timed scopes with wall and cpu time of the calling thread, counters are summed up,
+ * statistics keep their last value and lists collect all values.
+ */
+void enable_stats();
+bool stats_enabled();
+
+void add_counter(const std::string& name, long long value);
+void set_statistic(const std::string& name, double value);
+void append_statistic(const std::string& name, double value);
+
+class StatsPhase {
+public:
+  explicit StatsPhase(const char* name);
+  ~StatsPhase();
+
+  StatsPhase(const StatsPhase&) = delete;
+  StatsPhase& operator=(const StatsPhase&) = delete;
+
+private:
+  const char* m_Name;
+  bool m_Enabled;
+  std::chrono::steady_clock::time_point m_Start;
+  double m_CpuStart = 0;
+};
+
+// phases summed up by name, counters, statistics, process cpu time and peak memory as json
+void write_stats_json(std::ostream& stream);
+
+// every phase as complete event of the chrome trace event format, for chrome://tracing or perfetto
+void write_stats_trace(std::ostream& stream);
+
+// writes json and trace to the files, "stderr" writes to stderr. empty names are skipped
+void write_stats(const std::string& stats_path, const std::string& trace_path);
+
+} // namespace assign
@@ -0,0 +1,132 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <algorithm>
+#include "thread_pool.h"
+#include "common.h"
+
+using namespace assign;
+
+ThreadPool::ThreadPool(unsigned int threads)
+  : m_NextChunk(0), m_Pending(0)
+{
+  if(threads == 0){
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for(unsigned int i = 1; i < threads; ++i){
+    m_Workers.push_back(std::thread(&ThreadPool::work, this));
+  }
+}
+
+ThreadPool::~ThreadPool(){
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Wake.notify_all();
+  for(std::thread& worker : m_Workers){
+    worker.join();
+  }
+}
+
+unsigned int ThreadPool::size() const {
+  return m_Workers.size() + 1;
+}
+
+void ThreadPool::parallel_for(unsigned int count, const RangeTask& task, unsigned int chunk_size){
+  if(count == 0){
+    return;
+  }
+  if(m_Workers.empty() || count == 1){
+    task(0, count);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Task = &task;
+    m_Warnings = &warning_stream();
+    m_Count = count;
+    m_ChunkSize = chunk_size > 0 ? chunk_size : std::max(1u, count / (size() * 4));
+    m_Chunks = (count + m_ChunkSize - 1) / m_ChunkSize;
+    m_NextChunk = 0;
+    m_Pending = m_Chunks;
+    ++m_Generation;
+  }
+  m_Wake.notify_all();
+  runChunks();
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Done.wait(lock, [this]{ return m_Pending == 0 && m_Active == 0; });
+  m_Task = nullptr;
+  std::exception_ptr error = m_Error;
+  m_Error = nullptr;
+  lock.unlock();
+  if(error){
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::work(){
+  unsigned long seen = 0;
+  while(true){
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Wake.wait(lock, [this,seen]{ return m_Stop || m_Generation != seen; });
+      if(m_Stop) return;
+      seen = m_Generation;
+      if(m_Task == nullptr) continue; // job finished before this worker woke up
+      ++m_Active;
+      set_warning_stream(m_Warnings);
+    }
+    runChunks();
+    set_warning_stream(nullptr);
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      --m_Active;
+    }
+    m_Done.notify_all();
+  }
+}
+
+void ThreadPool::runChunks(){
+  while(true){
+    unsigned int chunk = m_NextChunk++;
+    if(chunk >= m_Chunks) return;
+    unsigned int begin = chunk * m_ChunkSize;
+    try {
+      (*m_Task)(begin, std::min(m_Count, begin + m_ChunkSize));
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if(!m_Error){
+        m_Error = std::current_exception();
+      }
+    }
+    if(--m_Pending == 0){
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Done.notify_all();
+    }
+  }
+}
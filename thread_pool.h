@@ -0,0 +1,86 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <ostream>
+
+namespace assign {
+
+/**
+ * Fixed set of worker threads for data parallel loops. The calling thread takes part in the work
+ * so a pool of size one runs everything inline.
+ */
+class ThreadPool {
+public:
+  typedef std::function<void(unsigned int begin, unsigned int end)> RangeTask;
+
+  // threads == 0 uses all available cores
+  explicit ThreadPool(unsigned int threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  unsigned int size() const;
+
+  // splits [0,count) into chunks and runs task on them in parallel. returns when all are done.
+  // idle threads take the next chunk. chunk_size 0 makes about four chunks per thread.
+  // the first exception thrown by task is rethrown here once all chunks are done.
+  // warnings of the workers go to the warning stream of the calling thread.
+  void parallel_for(unsigned int count, const RangeTask& task, unsigned int chunk_size = 0);
+
+private:
+  void work();
+  void runChunks();
+
+  std::vector<std::thread> m_Workers;
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;
+  std::condition_variable m_Done;
+  bool m_Stop = false;
+  unsigned long m_Generation = 0;
+  unsigned int m_Active = 0;
+  // current job
+  const RangeTask* m_Task = nullptr;
+  unsigned int m_Count = 0;
+  unsigned int m_ChunkSize = 1;
+  unsigned int m_Chunks = 0;
+  std::atomic<unsigned int> m_NextChunk;
+  std::atomic<unsigned int> m_Pending;
+  std::exception_ptr m_Error;
+  std::ostream* m_Warnings = nullptr;
+};
+
+} // namespace assign
@@ -0,0 +1,110 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include "whatif.h"
+
+using namespace assign;
+
+WhatIf::WhatIf(const DensePreferences& preferences, const std::vector<GroupId>& groups)
+  : m_Preferences(preferences), m_Groups(groups),
+    m_Moves(preferences, groups, group_capacity(preferences.size(), preferences.group_count))
+{
+  for(uint participant = 0; participant < preferences.size(); ++participant){
+    m_Moves.add(participant);
+  }
+  m_Exact = m_Moves.computePrices(m_Prices);
+}
+
+WhatIfAnswer WhatIf::move(uint participant, GroupId group) const {
+  WhatIfAnswer answer;
+  GroupId left = m_Groups[participant];
+  if(group == left){
+    answer.feasible = true;
+    return answer;
+  }
+  // the participant moves and a chain of the others fills its place or frees one in the group
+  std::vector<GroupMoves::Value> chains;
+  std::vector<int> next;
+  m_Moves.computeChains(left, m_Prices, chains, next, participant);
+  if(chains[group] == GroupMoves::UNREACHABLE){
+    return answer;
+  }
+  const Participant::Cost* row = m_Preferences.row(participant);
+  answer.feasible = true;
+  answer.delta = row[group] - row[left] + chains[group];
+  answer.moves.push_back(std::make_pair(participant, group));
+  m_Moves.appendChain(group, left, next, participant, answer.moves);
+  return answer;
+}
+
+WhatIfAnswer WhatIf::forbid(uint participant, GroupId group) const {
+  WhatIfAnswer answer;
+  GroupId left = m_Groups[participant];
+  if(group != left){
+    answer.feasible = true;
+    return answer;
+  }
+  std::vector<GroupMoves::Value> chains;
+  std::vector<int> next;
+  m_Moves.computeChains(left, m_Prices, chains, next, participant);
+  const Participant::Cost* row = m_Preferences.row(participant);
+  GroupId target = -1;
+  for(uint other = 0; other < m_Preferences.group_count; ++other){
+    if((GroupId) other == left || chains[other] == GroupMoves::UNREACHABLE){
+      continue;
+    }
+    long long delta = row[other] - row[left] + chains[other];
+    if(target < 0 || delta < answer.delta){
+      answer.delta = delta;
+      target = other;
+    }
+  }
+  if(target < 0){
+    answer.delta = 0;
+    return answer;
+  }
+  answer.feasible = true;
+  answer.moves.push_back(std::make_pair(participant, target));
+  m_Moves.appendChain(target, left, next, participant, answer.moves);
+  return answer;
+}
+
+WhatIfAnswer WhatIf::swap(uint first, uint second) const {
+  WhatIfAnswer answer;
+  answer.feasible = true;
+  GroupId first_group = m_Groups[first];
+  GroupId second_group = m_Groups[second];
+  if(first_group == second_group){
+    return answer;
+  }
+  const Participant::Cost* first_row = m_Preferences.row(first);
+  const Participant::Cost* second_row = m_Preferences.row(second);
+  answer.delta = first_row[second_group] - first_row[first_group] + second_row[first_group] - second_row[second_group];
+  answer.moves.push_back(std::make_pair(first, second_group));
+  answer.moves.push_back(std::make_pair(second, first_group));
+  return answer;
+}
@@ -0,0 +1,70 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+#include "moves.h"
+
+namespace assign {
+
+struct WhatIfAnswer {
+  bool feasible = false;
+  long long delta = 0; // change of the costs
+  std::vector<std::pair<uint,GroupId>> moves; // participant, new group
+};
+
+/**
+ * Answers what a change of an optimal single layer assignment costs without solving it again. The
+ * prices of the groups are computed once, every move or forbid query is then one shortest chain of
+ * moves between the groups in O(groups^2) and a swap is O(1). The deltas are exact for an optimal
+ * assignment and upper bounds otherwise, see exact(). Keeps references to the preferences and groups.
+ */
+class WhatIf {
+public:
+  WhatIf(const DensePreferences& preferences, const std::vector<GroupId>& groups);
+
+  // false when the assignment was not optimal
+  bool exact() const { return m_Exact; }
+
+  // cheapest assignment with the participant in the group
+  WhatIfAnswer move(uint participant, GroupId group) const;
+  // cheapest assignment without the participant in the group
+  WhatIfAnswer forbid(uint participant, GroupId group) const;
+  // the two participants exchange their groups, everyone else stays
+  WhatIfAnswer swap(uint first, uint second) const;
+
+private:
+  const DensePreferences& m_Preferences;
+  const std::vector<GroupId>& m_Groups;
+  GroupMoves m_Moves;
+  std::vector<GroupMoves::Value> m_Prices;
+  bool m_Exact = true;
+};
+
+} // namespace assign
@@ -0,0 +1,97 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#include <algorithm>
+#include "workspace.h"
+
+using namespace assign;
+
+SolverWorkspace::SolverWorkspace(SolverOptions options)
+  : m_Options(std::move(options))
+{}
+
+void SolverWorkspace::reserve(uint participants, uint group_count){
+  m_Groups.reserve(participants);
+  if(m_Options.solver == Solver::LAPJV && group_count > 0){
+    std::size_t slots = (std::size_t) group_count * group_capacity(participants, group_count);
+    m_LapCosts.reserve(participants * slots);
+    m_Lap.assigned.reserve(participants);
+    m_Lap.owner.reserve(slots);
+    m_Lap.potentials.reserve(slots);
+    m_Lap.free_agents.reserve(participants);
+    m_Lap.distances.reserve(slots);
+    m_Lap.offsets.reserve(slots);
+    m_Lap.predecessors.reserve(slots);
+    m_Lap.scanned.reserve(slots);
+  } else {
+    m_Preferences.ids.reserve(participants);
+    m_Preferences.costs.reserve((std::size_t) participants * group_count);
+  }
+}
+
+const std::vector<GroupId>& SolverWorkspace::solve(const Participant::Cost* costs, uint participants,
+                                                   uint group_count)
+{
+  m_Cost = 0;
+  if(participants == 0 || group_count == 0){
+    m_Groups.assign(participants, -1);
+    return m_Groups;
+  }
+  if(m_Options.solver == Solver::LAPJV && m_Options.time_limit_ms == 0){
+    solveLap(costs, participants, group_count);
+  } else {
+    m_Preferences.ids.resize(participants);
+    m_Preferences.group_count = group_count;
+    m_Preferences.costs.assign(costs, costs + (std::size_t) participants * group_count);
+    std::vector<GroupId> groups = solve_groups(m_Preferences, m_Options);
+    m_Groups.assign(groups.begin(), groups.end());
+  }
+  for(uint participant = 0; participant < participants; ++participant){
+    if(m_Groups[participant] >= 0){
+      m_Cost += costs[(std::size_t) participant * group_count + m_Groups[participant]];
+    }
+  }
+  return m_Groups;
+}
+
+// the replicated slots of every group as in the matrix solvers
+void SolverWorkspace::solveLap(const Participant::Cost* costs, uint participants, uint group_count){
+  uint slots = group_count * group_capacity(participants, group_count);
+  m_LapCosts.resize((std::size_t) participants * slots);
+  for(uint participant = 0; participant < participants; ++participant){
+    const Participant::Cost* src = costs + (std::size_t) participant * group_count;
+    Participant::Cost* row = m_LapCosts.data() + (std::size_t) participant * slots;
+    for(uint slot = 0; slot < slots; slot += group_count){
+      std::copy(src, src + group_count, row + slot);
+    }
+  }
+  const std::vector<int>& assigned = lap_solve(m_LapCosts.data(), participants, slots, m_Lap);
+  m_Groups.resize(participants);
+  for(uint participant = 0; participant < participants; ++participant){
+    m_Groups[participant] = assigned[participant] < 0 ? -1 : assigned[participant] % group_count;
+  }
+}
@@ -0,0 +1,69 @@
+/*********************************************************************
+* The MIT License (MIT)                                              *
+*                                                                    *
+* Copyright (c) 2015 Viktor Richter                                  *
+*                                                                    *
+* Permission is hereby granted, free of charge, to any person        *
+* obtaining a copy of this software and associated documentation     *
+* files (the "Software"), to deal in the Software without            *
+* restriction, including without limitation the rights               *
+* to use, copy, modify, merge, publish, distribute, sublicense,      *
+* and/or sell copies of the Software, and to permit persons to whom  *
+* the Software is furnished to do so, subject to the following       *
+* conditions:                                                        *
+*                                                                    *
+* The above copyright notice and this permission notice shall be     *
+* included in all copies or substantial portions of the Software.    *
+*                                                                    *
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,    *
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF *
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND              *
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT        *
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,       *
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, *
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER      *
+* DEALINGS IN THE SOFTWARE.                                          *
+*********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "common.h"
+#include "lap.h"
+
+namespace assign {
+
+/**
+ * Solves single layer assignments of row-major participants x groups costs and keeps all buffers
+ * between the solves. With the lapjv solver a solve which is not larger than an earlier one does
+ * not allocate. The other solvers only reuse the buffer of the preferences.
+ */
+class SolverWorkspace {
+public:
+  explicit SolverWorkspace(SolverOptions options = SolverOptions());
+
+  // grows the buffers for solves up to this size in advance
+  void reserve(uint participants, uint group_count);
+
+  // group of every participant or -1 when it could not be assigned. valid until the next solve
+  const std::vector<GroupId>& solve(const Participant::Cost* costs, uint participants, uint group_count);
+
+  // of the last solve
+  long long cost() const { return m_Cost; }
+
+  const SolverOptions& options() const { return m_Options; }
+
+private:
+  void solveLap(const Participant::Cost* costs, uint participants, uint group_count);
+
+  SolverOptions m_Options;
+  std::vector<GroupId> m_Groups;
+  long long m_Cost = 0;
+  // lapjv
+  std::vector<Participant::Cost> m_LapCosts;
+  LapWorkspace<Participant::Cost> m_Lap;
+  // other solvers
+  DensePreferences m_Preferences;
+};
+
+} // namespace assign